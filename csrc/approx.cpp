@@ -0,0 +1,64 @@
+/**
+ * Approximate evaluation at a coarse tick granularity.
+ *
+ * Usage: approx <granularity> <dataset> [<calibration dataset>...]
+ * A dataset is either a file serialized by client.cpp,
+ * or the index (0 ~ 3) of a preset in testcase_array.
+ *
+ * The error bound is the largest SLO error measured against exact runs
+ * on the calibration datasets. It is only as good as those datasets.
+ */
+#include "runtime.h"
+#include "approx.h"
+#include "src.hpp"
+
+namespace oj::detail::runtime {
+
+static auto approx(time_t granularity, std::span <const std::string> names) {
+    auto [desc, tasks] = load_dataset(names[0]);
+
+    double error = 0;
+    for (const auto &name : names.subspan(1)) {
+        auto [desc, tasks] = load_dataset(name);
+        const auto result = calibrate(desc, tasks, granularity);
+        const auto delta = std::abs(result.slo_exact - result.slo_coarse);
+        error = std::max(error, delta);
+        std::cout << std::fixed << std::setprecision(6)
+                  << "calibrate " << name
+                  << " exact " << result.slo_exact
+                  << " coarse " << result.slo_coarse
+                  << " error " << delta
+                  << " speedup " << result.time_exact / result.time_coarse
+                  << std::endl;
+    }
+
+    const auto slo = run_isolated([&]() -> double {
+        return slo_rate(schedule_coarse(desc, tasks, granularity));
+    });
+
+    std::cout << std::fixed << std::setprecision(6)
+              << "estimate " << names[0] << " slo " << slo;
+    if (names.size() > 1)
+        std::cout << " +- " << error;
+    else
+        std::cout << " (uncalibrated)";
+    std::cout << " granularity " << granularity << std::endl;
+}
+
+} // namespace oj::detail::runtime
+
+signed main(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <granularity> <dataset> [<calibration dataset>...]\n";
+        return 1;
+    }
+    try {
+        const std::vector <std::string> names(argv + 2, argv + argc);
+        oj::detail::runtime::approx(std::stoul(argv[1]), names);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
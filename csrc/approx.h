@@ -0,0 +1,104 @@
+#pragma once
+#include "runtime.h"
+#include "harness.h"
+#include <chrono>
+
+/**
+ * Coarse-tick approximation: every G ticks are simulated as one.
+ * Times are divided by G, and so is the work, since a coarse tick
+ * executes G times the work of a fine one. kStartUp and kSaving are
+ * rounded to the nearest count of coarse ticks, which may be zero.
+ */
+namespace oj::detail::runtime {
+
+inline auto coarsen(const Task &task, time_t granularity) -> Task {
+    const auto launch_time = task.launch_time / granularity;
+    return Task {
+        .launch_time    = launch_time,
+        .deadline       = std::max(task.deadline / granularity, launch_time + 1),
+        .execution_time = (task.execution_time + granularity - 1) / granularity,
+        .priority       = task.priority,
+    };
+}
+
+inline auto coarsen(const Description &desc, time_t granularity) -> Description {
+    auto result = desc;
+    auto coarsen_range = [granularity](Range <time_t> &range) {
+        range.min = range.min / granularity;
+        range.max = (range.max + granularity - 1) / granularity;
+    };
+    coarsen_range(result.deadline_time);
+    coarsen_range(result.execution_time_single);
+    coarsen_range(result.execution_time_sum);
+    return result;
+}
+
+inline auto coarsen(const Cluster &cluster, time_t granularity) -> Cluster {
+    return Cluster {
+        .cpu_count  = cluster.cpu_count,
+        .start_up   = (cluster.start_up + granularity / 2) / granularity,
+        .saving     = (cluster.saving + granularity / 2) / granularity,
+    };
+}
+
+/**
+ * @brief Same as schedule_work, but at a granularity of G ticks.
+ * The scheduler sees the coarse times and the coarse description.
+ */
+[[maybe_unused]]
+static auto schedule_coarse(
+    const Description &desc, std::span <const Task> tasks, time_t granularity)
+-> ServiceInfo {
+    if (granularity == 0)
+        panic <SystemException> ("Granularity should not be zero.");
+
+    std::vector <Task> coarse;
+    coarse.reserve(tasks.size());
+    for (const auto &task : tasks)
+        coarse.push_back(coarsen(task, granularity));
+
+    const auto cluster = coarsen(Cluster { .cpu_count = desc.cpu_count }, granularity);
+    RuntimeManager manager { std::move(coarse), cluster };
+    return schedule_loop(coarsen(desc, granularity), manager);
+}
+
+struct Calibration {
+    double slo_exact;
+    double slo_coarse;
+    double time_exact;  // In seconds.
+    double time_coarse; // In seconds.
+};
+
+/* Run both the exact and the coarse simulation, each in a fresh process. */
+[[maybe_unused]]
+static auto calibrate(
+    const Description &desc, std::span <const Task> tasks, time_t granularity)
+-> Calibration {
+    using clock = std::chrono::steady_clock;
+    struct Run {
+        double slo;
+        double time;
+    };
+
+    const auto exact = run_isolated([&]() -> Run {
+        const auto start = clock::now();
+        const auto info = schedule_work(desc, { tasks.begin(), tasks.end() });
+        const auto time = std::chrono::duration <double> (clock::now() - start);
+        return { slo_rate(info), time.count() };
+    });
+    const auto coarse = run_isolated([&]() -> Run {
+        const auto start = clock::now();
+        const auto info = schedule_coarse(desc, tasks, granularity);
+        const auto time = std::chrono::duration <double> (clock::now() - start);
+        return { slo_rate(info), time.count() };
+    });
+
+    return Calibration {
+        .slo_exact      = exact.slo,
+        .slo_coarse     = coarse.slo,
+        .time_exact     = exact.time,
+        .time_coarse    = coarse.time,
+    };
+}
+
+} // namespace oj::detail::runtime
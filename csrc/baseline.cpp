@@ -0,0 +1,158 @@
+/**
+ * Record performance baselines, and compare new runs against them.
+ *
+ * Usage: baseline record  -s store -k key [-r runs] <dataset>...
+ *        baseline compare -s store -k key [-b base] [-r runs] [-a alpha] [-e tolerance] <dataset>...
+ * A dataset is either a file serialized by client.cpp,
+ * or the index (0 ~ 3) of a preset in testcase_array.
+ *
+ * The scheduler measured is the one built in: src.hpp, unless built with
+ * -DOJ_SCHEDULER='"other.hpp"'. The key names it in the store. record
+ * adds the runs under the key, and compare gates the runs against the
+ * baseline under the base key, by default the same key. E.g. a new
+ * scheduler, built as key "new", may be gated with -b against "ref".
+ *
+ * compare exits with 2 if any metric regressed: it is worse with a
+ * p-value below alpha (default 0.01), by more than the relative
+ * tolerance (default 0.02). The SLO may not drop at all.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "baseline.h"
+#ifdef OJ_SCHEDULER
+#include OJ_SCHEDULER
+#else
+#include "src.hpp"
+#endif
+
+namespace oj::detail::runtime {
+
+struct Options {
+    std::string                 store;
+    std::string                 key;        // Of the scheduler built in
+    std::string                 base;       // Compared against, if not key
+    std::size_t                 runs = 5;
+    double                      alpha = 0.01;
+    double                      tolerance = 0.02;
+    std::vector <std::string>   datasets;
+};
+
+static auto measure_runs(const std::string &dataset, std::size_t runs)
+-> std::vector <BaselineSample> {
+    std::vector <BaselineSample> samples;
+    for (std::size_t i = 0; i < runs; ++i)
+        samples.push_back(measure_baseline(dataset));
+    return samples;
+}
+
+static void record(const Options &options) {
+    for (const auto &dataset : options.datasets) {
+        const auto samples = measure_runs(dataset, options.runs);
+        BaselineStore::append(options.store, { options.key, dataset }, samples);
+        std::cout << "recorded " << options.key << ' ' << dataset
+                  << " runs " << samples.size() << std::endl;
+    }
+}
+
+/* @return Whether any metric regressed. */
+static auto compare(const Options &options) -> bool {
+    struct Metric {
+        std::string_view name;
+        double (*get)(const BaselineSample &);
+        double tolerance;
+    };
+
+    // All metrics are negated where higher is better, so higher is worse.
+    const Metric metrics[] = {
+        { "wall", [](const BaselineSample &s) { return s.wall; }, options.tolerance },
+        { "p99", [](const BaselineSample &s) { return s.p99; }, options.tolerance },
+        { "peak_rss", [](const BaselineSample &s) { return s.peak_rss; }, options.tolerance },
+        { "slo", [](const BaselineSample &s) { return -slo_rate(s.info); }, 0 },
+    };
+
+    const auto store = BaselineStore::load(options.store);
+    const auto &key = options.base.empty() ? options.key : options.base;
+    bool regressed = false;
+
+    std::cout << std::fixed;
+    for (const auto &dataset : options.datasets) {
+        const auto base = store.find({ key, dataset });
+        if (base.empty()) {
+            std::cout << "missing " << key << ' ' << dataset << std::endl;
+            regressed = true;
+            continue;
+        }
+
+        const auto next = measure_runs(dataset, options.runs);
+        for (const auto &metric : metrics) {
+            std::vector <double> x, y;
+            for (const auto &sample : base) x.push_back(metric.get(sample));
+            for (const auto &sample : next) y.push_back(metric.get(sample));
+
+            const auto test = welch_test(x, y);
+            const auto scale = std::max(std::abs(test.mean_base), 1e-12);
+            const auto change = (test.mean_new - test.mean_base) / scale;
+            const bool bad = test.p_greater < options.alpha && change > metric.tolerance;
+            regressed |= bad;
+
+            // Print SLO as is, not negated.
+            const auto sign = metric.name == "slo" ? -1.0 : 1.0;
+            std::cout << std::setprecision(6)
+                      << dataset << ' ' << metric.name
+                      << " base " << sign * test.mean_base
+                      << " new " << sign * test.mean_new
+                      << std::setprecision(2)
+                      << " change " << (change == 0 ? 0.0 : 100 * sign * change) << '%'
+                      << std::setprecision(4)
+                      << " p " << test.p_greater
+                      << (bad ? " REGRESSED" : " ok") << std::endl;
+        }
+    }
+    return regressed;
+}
+
+} // namespace oj::detail::runtime
+
+signed main(int argc, char *argv[]) {
+    oj::detail::runtime::Options options;
+    const std::string_view command = argc > 1 ? argv[1] : "";
+
+    try {
+        if (command != "record" && command != "compare")
+            throw std::invalid_argument("Unknown command.");
+        for (int i = 2; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            const bool has_value = i + 1 < argc;
+            if (arg == "-s" && has_value) options.store = argv[++i];
+            else if (arg == "-k" && has_value) options.key = argv[++i];
+            else if (arg == "-b" && has_value) options.base = argv[++i];
+            else if (arg == "-r" && has_value) options.runs = std::stoul(argv[++i]);
+            else if (arg == "-a" && has_value) options.alpha = std::stod(argv[++i]);
+            else if (arg == "-e" && has_value) options.tolerance = std::stod(argv[++i]);
+            else options.datasets.emplace_back(arg);
+        }
+        if (options.store.empty() || options.key.empty() || options.datasets.empty())
+            throw std::invalid_argument("Missing arguments.");
+        if (command == "record" && !options.base.empty())
+            throw std::invalid_argument("A base is only for compare.");
+        if (options.key.find_first_of("\t\n") != std::string::npos)
+            throw std::invalid_argument("Bad key.");
+    } catch (const std::exception &) {
+        std::cerr << "Usage: " << argv[0] << " record -s store -k key [-r runs] <dataset>...\n"
+                  << "       " << argv[0] << " compare -s store -k key [-b base] [-r runs]"
+                     " [-a alpha] [-e tolerance] <dataset>...\n";
+        return 1;
+    }
+
+    try {
+        if (command == "record") {
+            oj::detail::runtime::record(options);
+        } else if (oj::detail::runtime::compare(options)) {
+            return 2;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
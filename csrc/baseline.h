@@ -0,0 +1,178 @@
+#pragma once
+#include "runtime.h"
+#include "harness.h"
+#include "profile.h"
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <sys/resource.h>
+
+/**
+ * Performance baselines: repeated runs of a scheduler on a dataset are
+ * stored as samples, keyed by (scheduler, dataset). New samples are then
+ * compared against them, and a metric regresses when it is worse by
+ * Welch's t-test and by more than a tolerance.
+ */
+namespace oj::detail::runtime {
+
+/* One run. Trivially copyable, to come back from run_isolated. */
+struct BaselineSample {
+    double          wall;       // Seconds in schedule_work
+    double          p99;        // Nanoseconds of schedule_tasks per tick
+    double          peak_rss;   // Bytes
+    ServiceInfo     info;
+};
+
+/* Run the dataset once, in a fresh process. */
+[[maybe_unused]]
+static auto measure_baseline(const std::string &dataset) -> BaselineSample {
+    return run_isolated([&]() -> BaselineSample {
+        using clock = std::chrono::steady_clock;
+        auto [desc, tasks] = load_dataset(dataset);
+
+        LatencyProbe latency { 0 };
+        const auto start = clock::now();
+        const auto info = schedule_work(desc, std::move(tasks), latency);
+        const auto wall = std::chrono::duration <double> (clock::now() - start).count();
+
+        rusage usage {};
+        ::getrusage(RUSAGE_SELF, &usage);
+        return BaselineSample {
+            .wall       = wall,
+            .p99        = latency.to_nanos(latency.schedule.percentile(99)),
+            .peak_rss   = double(usage.ru_maxrss) * 1024,
+            .info       = info,
+        };
+    });
+}
+
+/**
+ * @brief The samples of each (scheduler, dataset), kept in a text file,
+ * one sample per line: scheduler, dataset, wall, p99, peak_rss, complete
+ * and total, separated by tabs.
+ */
+struct BaselineStore {
+    using Key = std::pair <std::string, std::string>;
+
+    static auto load(const std::filesystem::path &path) -> BaselineStore {
+        BaselineStore store;
+        std::ifstream file { path };
+        if (!file.is_open()) return store;
+
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty()) continue;
+            std::istringstream is { line };
+            std::string scheduler, dataset;
+            BaselineSample sample {};
+            if (!std::getline(is, scheduler, '\t') || !std::getline(is, dataset, '\t')
+            || !(is >> sample.wall >> sample.p99 >> sample.peak_rss
+                    >> sample.info.complete >> sample.info.total))
+                panic <SystemException> ("Baseline: Malformed line: " + line);
+            store.samples[{ scheduler, dataset }].push_back(sample);
+        }
+        return store;
+    }
+
+    /* Append the samples, keeping those already in the file. */
+    static void append(const std::filesystem::path &path, const Key &key,
+        std::span <const BaselineSample> samples) {
+        std::ofstream file { path, std::ios::app };
+        if (!file.is_open())
+            panic <SystemException> ("Baseline: Cannot write " + path.string());
+        file << std::setprecision(9);
+        for (const auto &sample : samples) {
+            file << key.first << '\t' << key.second << '\t'
+                 << sample.wall << '\t' << sample.p99 << '\t' << sample.peak_rss << '\t'
+                 << sample.info.complete << '\t' << sample.info.total << '\n';
+        }
+    }
+
+    auto find(const Key &key) const -> std::span <const BaselineSample> {
+        const auto iter = samples.find(key);
+        if (iter == samples.end()) return {};
+        return iter->second;
+    }
+
+    std::map <Key, std::vector <BaselineSample>> samples;
+};
+
+/* The regularized incomplete beta function, by Lentz's continued fraction. */
+inline auto incomplete_beta(double a, double b, double x) -> double {
+    if (x <= 0) return 0;
+    if (x >= 1) return 1;
+    // The fraction converges fast only below the mean.
+    if (x > (a + 1) / (a + b + 2))
+        return 1 - incomplete_beta(b, a, 1 - x);
+
+    constexpr double kTiny = 1e-300;
+    constexpr double kEpsilon = 1e-12;
+    const auto front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b)
+        + a * std::log(x) + b * std::log(1 - x)) / a;
+
+    double f = 1, c = 1, d = 0;
+    for (int i = 0; i <= 200; ++i) {
+        const int m = i / 2;
+        double numerator;
+        if (i == 0) numerator = 1;
+        else if (i % 2 == 0) numerator = m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+        else numerator = -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+
+        d = 1 + numerator * d;
+        if (std::abs(d) < kTiny) d = kTiny;
+        d = 1 / d;
+        c = 1 + numerator / c;
+        if (std::abs(c) < kTiny) c = kTiny;
+        f *= c * d;
+        if (std::abs(1 - c * d) < kEpsilon) break;
+    }
+    return front * (f - 1);
+}
+
+/* P(T > t) for Student's t-distribution with df degrees of freedom. */
+inline auto student_t_upper(double t, double df) -> double {
+    const auto tail = 0.5 * incomplete_beta(df / 2, 0.5, df / (df + t * t));
+    return t > 0 ? tail : 1 - tail;
+}
+
+struct WelchResult {
+    double  mean_base;
+    double  mean_new;
+    double  t;
+    double  df;
+    double  p_greater;  // P-value of mean_new > mean_base
+};
+
+/* Welch's t-test, with one-sided p-value that the new mean is greater. */
+inline auto welch_test(std::span <const double> base, std::span <const double> next) -> WelchResult {
+    auto moments = [](std::span <const double> values) {
+        const auto n = double(values.size());
+        const auto mean = std::accumulate(values.begin(), values.end(), 0.0) / n;
+        double variance = 0;
+        for (const auto x : values) variance += (x - mean) * (x - mean);
+        return std::pair { mean, values.size() < 2 ? 0.0 : variance / (n - 1) };
+    };
+
+    const auto [mean_base, var_base] = moments(base);
+    const auto [mean_new, var_new] = moments(next);
+    const auto se_base = var_base / base.size();
+    const auto se_new = var_new / next.size();
+    const auto se = se_base + se_new;
+
+    WelchResult result { mean_base, mean_new, 0, 0, 0.5 };
+    if (se == 0) {
+        // No noise at all: any difference is certain.
+        result.p_greater = mean_new > mean_base ? 0 : 1;
+        return result;
+    }
+    if (base.size() < 2 || next.size() < 2) return result;
+
+    result.t = (mean_new - mean_base) / std::sqrt(se);
+    result.df = se * se / (se_base * se_base / (base.size() - 1) + se_new * se_new / (next.size() - 1));
+    result.p_greater = student_t_upper(result.t, result.df);
+    return result;
+}
+
+} // namespace oj::detail::runtime
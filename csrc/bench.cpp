@@ -0,0 +1,269 @@
+/**
+ * Microbenchmarks of RuntimeManager, one JSON object per line.
+ *
+ * Usage: bench [-f filter] [-n max] [-r repeat]
+ * Each case runs at task counts 10^3, 10^4, ... up to max (default 10^6),
+ * and reports the best of `repeat` runs (default 3). Only the cases whose
+ * name contains the filter are run. The schedule_* cases run src.hpp,
+ * unless built with -DOJ_SCHEDULER='"other.hpp"', each in a fresh child.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "pipeline.h"
+#include "trace.h"
+#ifdef OJ_SCHEDULER
+#include OJ_SCHEDULER
+#else
+#include "src.hpp"
+#endif
+#include <atomic>
+#include <chrono>
+
+namespace oj::detail::runtime {
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+/* All the tasks arrive at the time, with deadlines far away. */
+auto make_tasks(std::size_t count, time_t launch_time = 0) -> std::vector <Task> {
+    std::vector <Task> tasks(count);
+    for (auto &task : tasks) {
+        task = Task {
+            .launch_time    = launch_time,
+            .deadline       = launch_time + (time_t(1) << 40),
+            .execution_time = 1 << 20,
+            .priority       = 1,
+        };
+    }
+    return tasks;
+}
+
+/* A manager with all the tasks arrived, with enough CPUs to launch them all. */
+auto make_manager(std::size_t count) -> std::unique_ptr <RuntimeManager> {
+    auto manager = std::make_unique <RuntimeManager> (
+        make_tasks(count), Cluster { .cpu_count = cpu_id_t(count) });
+    manager->synchronize();
+    return manager;
+}
+
+template <typename _Policy>
+auto make_policies(std::size_t count) -> std::vector <Policy> {
+    std::vector <Policy> policies;
+    policies.reserve(count);
+    for (task_id_t i = 0; i < count; ++i) {
+        if constexpr (std::is_same_v <_Policy, Launch>)
+            policies.push_back(Launch { .cpu_cnt = 1, .task_id = i });
+        else
+            policies.push_back(_Policy { .task_id = i });
+    }
+    return policies;
+}
+
+/**
+ * A case prepares the state for a task count, then returns the timed
+ * part, and the number of operations it performs. An isolated case is
+ * prepared and run in a child, as the scheduler keeps its state in
+ * globals.
+ */
+struct Case {
+    std::string_view name;
+    std::function <std::pair <std::function <void ()>, std::size_t> (std::size_t)> prepare;
+    bool isolated = false;
+};
+
+struct Timing {
+    clock::rep      elapsed;
+    std::size_t     ops;
+};
+
+/* Keeps the compiler from dropping the result. */
+std::atomic <std::uint64_t> sink;
+
+/**
+ * A whole run of the scheduler on n tasks, one arriving every few ticks, so that
+ * most ticks have no arrival and may be planned ahead by the pipeline.
+ */
+template <auto _Schedule>
+auto prepare_run(std::size_t n) -> std::pair <std::function <void ()>, std::size_t> {
+    constexpr time_t kGap = 8;
+    std::vector <Task> tasks(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        tasks[i] = Task {
+            .launch_time    = i * kGap,
+            .deadline       = i * kGap + 4 * kGap,
+            .execution_time = 2 * kGap,
+            .priority       = 1,
+        };
+    }
+    const Description desc {
+        .cpu_count              = 4,
+        .task_count             = n,
+        .deadline_time          = { .min = 4 * kGap, .max = (n + 3) * kGap },
+        .execution_time_single  = { .min = 2 * kGap, .max = 2 * kGap },
+        .execution_time_sum     = { .min = 2 * kGap * n, .max = 2 * kGap * n },
+        .priority_single        = { .min = 1, .max = 1 },
+        .priority_sum           = { .min = n, .max = n },
+    };
+
+    auto shared = std::make_shared <std::vector <Task>> (std::move(tasks));
+    return { [desc, shared] {
+        sink += _Schedule(desc, std::move(*shared)).complete;
+    }, desc.deadline_time.max + 1 };
+}
+
+const Case kCases[] = {
+    { "synchronize_dense", [](std::size_t n) {
+        // n tasks arrive at once.
+        auto manager = std::make_shared <RuntimeManager> (make_tasks(n), Cluster {});
+        return std::pair { std::function <void ()> ([manager] {
+            sink += manager->synchronize().size();
+        }), n };
+    } },
+    { "synchronize_sparse", [](std::size_t n) {
+        // One task arrives at each of n ticks.
+        std::vector <Task> tasks;
+        tasks.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+            tasks.push_back(make_tasks(1, i)[0]);
+        auto manager = std::make_shared <RuntimeManager> (std::move(tasks), Cluster {});
+        return std::pair { std::function <void ()> ([manager, n] {
+            for (std::size_t i = 0; i < n; ++i)
+                sink += manager->synchronize().size();
+        }), n };
+    } },
+    { "synchronize_idle", [](std::size_t n) {
+        // n live tasks, 10^5 ticks with nothing to do.
+        constexpr std::size_t kTicks = 100000;
+        auto manager = std::shared_ptr <RuntimeManager> (make_manager(n));
+        return std::pair { std::function <void ()> ([manager] {
+            for (std::size_t i = 0; i < kTicks; ++i)
+                sink += manager->synchronize().size();
+        }), kTicks };
+    } },
+    { "work_launch", [](std::size_t n) {
+        auto manager = std::shared_ptr <RuntimeManager> (make_manager(n));
+        auto policies = std::make_shared <std::vector <Policy>> (make_policies <Launch> (n));
+        return std::pair { std::function <void ()> ([manager, policies] {
+            manager->work(std::move(*policies));
+        }), n };
+    } },
+    { "work_saving", [](std::size_t n) {
+        auto manager = std::shared_ptr <RuntimeManager> (make_manager(n));
+        manager->work(make_policies <Launch> (n));
+        manager->synchronize();
+        auto policies = std::make_shared <std::vector <Policy>> (make_policies <Saving> (n));
+        return std::pair { std::function <void ()> ([manager, policies] {
+            manager->work(std::move(*policies));
+        }), n };
+    } },
+    { "work_cancel", [](std::size_t n) {
+        auto manager = std::shared_ptr <RuntimeManager> (make_manager(n));
+        manager->work(make_policies <Launch> (n));
+        manager->synchronize();
+        auto policies = std::make_shared <std::vector <Policy>> (make_policies <Cancel> (n));
+        return std::pair { std::function <void ()> ([manager, policies] {
+            manager->work(std::move(*policies));
+        }), n };
+    } },
+    { "complete_saving", [](std::size_t n) {
+        // A saving set of n containers, all finishing at the same tick.
+        auto manager = std::shared_ptr <RuntimeManager> (make_manager(n));
+        manager->work(make_policies <Launch> (n));
+        manager->synchronize();
+        manager->work(make_policies <Saving> (n));
+        return std::pair { std::function <void ()> ([manager] {
+            const auto finish = manager->get_time() + manager->get_cluster().saving;
+            sink += manager->skip_to(finish + 1).size();
+        }), n };
+    } },
+    // The same run, with schedule_tasks on the caller or its own thread.
+    { "schedule_serial", [](std::size_t n) {
+        return prepare_run <[](const Description &desc, std::vector <Task> tasks) {
+            return schedule_work(desc, std::move(tasks));
+        }> (n);
+    }, true },
+    { "schedule_pipelined", [](std::size_t n) {
+        return prepare_run <[](const Description &desc, std::vector <Task> tasks) {
+            return schedule_pipelined(desc, std::move(tasks));
+        }> (n);
+    }, true },
+    // The serial run again, exporting its timeline to /dev/null.
+    { "schedule_traced", [](std::size_t n) {
+        return prepare_run <[](const Description &desc, std::vector <Task> tasks) {
+            TraceExporter exporter { "/dev/null" };
+            return schedule_work(desc, std::move(tasks), exporter);
+        }> (n);
+    }, true },
+    { "get_service_info", [](std::size_t n) {
+        // 10^6 calls with n live tasks.
+        constexpr std::size_t kCalls = 1000000;
+        auto manager = std::shared_ptr <RuntimeManager> (make_manager(n));
+        return std::pair { std::function <void ()> ([manager] {
+            for (std::size_t i = 0; i < kCalls; ++i)
+                sink += manager->get_service_info().total;
+        }), kCalls };
+    } },
+};
+
+/* Prepare the case for n tasks, and time its run. */
+auto measure(const Case &bench_case, std::size_t n) -> Timing {
+    auto [run, ops] = bench_case.prepare(n);
+    const auto start = clock::now();
+    run();
+    return { (clock::now() - start).count(), ops };
+}
+
+} // namespace
+
+static void bench(std::string_view filter, std::size_t max_count, std::size_t repeat) {
+    for (const auto &bench_case : kCases) {
+        if (bench_case.name.find(filter) == std::string_view::npos) continue;
+        for (std::size_t n = 1000; n <= max_count; n *= 10) {
+            auto best = clock::duration::max();
+            std::size_t ops = 0;
+            for (std::size_t i = 0; i < repeat; ++i) {
+                const auto timing = bench_case.isolated
+                    ? run_isolated([&] { return measure(bench_case, n); })
+                    : measure(bench_case, n);
+                best = std::min(best, clock::duration(timing.elapsed));
+                ops = timing.ops;
+            }
+            const auto nanos = std::chrono::duration <double, std::nano> (best).count();
+            std::cout << std::fixed << std::setprecision(2)
+                      << R"({"bench":")" << bench_case.name
+                      << R"(","tasks":)" << n
+                      << R"(,"ops":)" << ops
+                      << R"(,"total_ns":)" << nanos
+                      << R"(,"ns_per_op":)" << nanos / std::max <std::size_t> (ops, 1)
+                      << "}" << std::endl;
+        }
+    }
+}
+
+} // namespace oj::detail::runtime
+
+signed main(int argc, char *argv[]) {
+    std::string_view filter;
+    std::size_t max_count = 1000000;
+    std::size_t repeat = 3;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "-f" && i + 1 < argc) filter = argv[++i];
+        else if (arg == "-n" && i + 1 < argc) max_count = std::stoull(argv[++i]);
+        else if (arg == "-r" && i + 1 < argc) repeat = std::max(std::stoull(argv[++i]), 1ull);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-f filter] [-n max] [-r repeat]\n";
+            return 1;
+        }
+    }
+
+    try {
+        oj::detail::runtime::bench(filter, max_count, repeat);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
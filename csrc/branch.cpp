@@ -0,0 +1,98 @@
+/**
+ * Replay a recorded run up to a tick, let another scheduler go on from
+ * there, and report the change of SLO rate against the recording.
+ *
+ * Usage: branch [-j parallel] <dataset> <trace> <tick>:<scheduler>...
+ * The trace is made by `replay record`. A scheduler is one of primary
+ * (schedule_tasks), idle or save (see budget.h). It takes over once the
+ * containers running at the tick are saved, at the origin reported.
+ * The primary is src.hpp, unless built with -DOJ_SCHEDULER='"other.hpp"'.
+ * A dataset is either a file serialized by client.cpp,
+ * or the index (0 ~ 3) of a preset in testcase_array.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "budget.h"
+#include "branch.h"
+#ifdef OJ_SCHEDULER
+#include OJ_SCHEDULER
+#else
+#include "src.hpp"
+#endif
+#include <fstream>
+
+namespace oj::detail::runtime {
+
+static auto make_scheduler(std::string_view name) -> TickScheduler {
+    if (name == "primary")
+        return [](time_t time, std::vector <Task> list, const Description &desc) {
+            return schedule_tasks(time, std::move(list), desc);
+        };
+    if (name == "idle") return idle_fallback();
+    if (name == "save") return save_fallback();
+    panic <SystemException> ("Branch: Unknown scheduler " + std::string(name));
+}
+
+static auto parse_branch(std::string_view arg) -> Branch {
+    const auto colon = arg.find(':');
+    if (colon == arg.npos)
+        throw std::invalid_argument("Branch should be tick:scheduler.");
+    return Branch {
+        .tick       = time_t(std::stoull(std::string(arg.substr(0, colon)))),
+        .scheduler  = std::string(arg.substr(colon + 1)),
+    };
+}
+
+} // namespace oj::detail::runtime
+
+signed main(int argc, char *argv[]) {
+    using namespace oj::detail::runtime;
+
+    std::size_t parallel = 1;
+    std::vector <std::string_view> args;
+    std::vector <Branch> branches;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            if (arg == "-j" && i + 1 < argc) parallel = std::stoul(argv[++i]);
+            else args.push_back(arg);
+        }
+        if (args.size() < 3) throw std::invalid_argument("Missing arguments.");
+        for (std::size_t i = 2; i < args.size(); ++i)
+            branches.push_back(parse_branch(args[i]));
+    } catch (const std::exception &) {
+        std::cerr << "Usage: " << argv[0] << " [-j parallel] <dataset> <trace> <tick>:<scheduler>...\n";
+        return 1;
+    }
+
+    try {
+        auto [desc, tasks] = load_dataset(std::string(args[0]));
+        std::ifstream trace { std::string(args[1]), std::ios::binary };
+        if (!trace.is_open())
+            panic <SystemException> ("Trace: Cannot read " + std::string(args[1]));
+
+        const auto [recorded, results] = run_branches(
+            desc, std::move(tasks), trace, branches, make_scheduler, parallel);
+
+        std::cout << std::fixed << std::setprecision(6)
+                  << "recorded complete " << recorded.complete
+                  << " total " << recorded.total
+                  << " slo " << slo_rate(recorded) << '\n';
+        for (std::size_t i = 0; i < branches.size(); ++i) {
+            const auto &[info, origin, seconds] = results[i];
+            std::cout << "branch " << branches[i].tick << ':' << branches[i].scheduler
+                      << " origin " << origin
+                      << " complete " << info.complete
+                      << " total " << info.total
+                      << " slo " << slo_rate(info)
+                      << " delta " << slo_rate(info) - slo_rate(recorded)
+                      << " seconds " << seconds << '\n';
+        }
+        std::cout.flush();
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
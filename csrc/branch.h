@@ -0,0 +1,99 @@
+#pragma once
+#include "runtime.h"
+#include "harness.h"
+#include "replay.h"
+#include "handover.h"
+#include <chrono>
+#include <numeric>
+
+/**
+ * Counterfactual branches of a recorded run: the trace is replayed up to
+ * a tick, then another scheduler goes on from there. The prefix is only
+ * replayed once, in order of tick, and each branch is forked from it.
+ * The containers still running at the tick are saved first, and the other
+ * scheduler takes over once all the CPUs are released, as in Handover.
+ */
+namespace oj::detail::runtime {
+
+struct Branch {
+    time_t      tick;       // The first tick of the other scheduler
+    std::string scheduler;  // Made by the SchedulerFactory
+};
+
+/* Trivially copyable, to come back from a child. */
+struct BranchResult {
+    ServiceInfo info;
+    time_t      origin;     // The first tick of the other scheduler
+    double      seconds;    // From the tick on
+};
+
+/**
+ * @brief Makes a scheduler by name, within the child of the branch.
+ * A scheduler keeping its state in globals still starts fresh, as the
+ * parent only replays and never schedules.
+ */
+using SchedulerFactory = std::function <TickScheduler (std::string_view)>;
+
+/**
+ * @brief Run the branches, at most `parallel` at a time.
+ * @return The service recorded in the trace, and that of each branch.
+ */
+[[maybe_unused]]
+static auto run_branches(const Description &desc, std::vector <Task> tasks, std::istream &trace,
+    std::span <const Branch> branches, const SchedulerFactory &factory, std::size_t parallel)
+-> std::pair <ServiceInfo, std::vector <BranchResult>> {
+    using clock = std::chrono::steady_clock;
+    parallel = std::max <std::size_t> (parallel, 1);
+
+    for (const auto &branch : branches)
+        if (branch.tick > desc.deadline_time.max)
+            panic <SystemException> ("Branch: Tick is past the max deadline.");
+
+    std::vector <std::size_t> order(branches.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_sort(order, {}, [&](std::size_t i) { return branches[i].tick; });
+
+    RuntimeManager manager { std::move(tasks), { .cpu_count = desc.cpu_count } };
+    PolicyReader reader { trace };
+    TraceReplayer replayer { manager, reader, true };
+
+    std::vector <std::pair <std::size_t, Isolated <BranchResult>>> children;
+    std::vector <BranchResult> results(branches.size());
+    std::size_t joined = 0;
+    auto join_next = [&] {
+        auto &[which, child] = children[joined++];
+        results[which] = join_isolated(child);
+    };
+
+    for (const auto which : order) {
+        const auto &branch = branches[which];
+        replayer.replay_until(branch.tick);
+        if (children.size() - joined == parallel) join_next();
+        children.emplace_back(which, spawn_isolated([&]() -> BranchResult {
+            const auto start = clock::now();
+            replayer.drain();
+            const auto origin = manager.get_time() + 1;
+
+            const auto &arrived = replayer.get_arrived();
+            std::vector <std::pair <task_id_t, Task>> earlier;
+            earlier.reserve(arrived.size());
+            for (task_id_t i = 0; i < arrived.size(); ++i)
+                earlier.emplace_back(i, arrived[i]);
+
+            Handover handover { factory(branch.scheduler), std::move(earlier), arrived.size() };
+            const auto info = schedule_loop_with(desc, manager, handover);
+            return BranchResult {
+                .info       = info,
+                .origin     = origin,
+                .seconds    = std::chrono::duration <double> (clock::now() - start).count(),
+            };
+        }));
+    }
+
+    // Replaying the rest also checks the trace against the tasks.
+    const auto recorded = replayer.finish();
+    while (joined < children.size()) join_next();
+    return { recorded, std::move(results) };
+}
+
+} // namespace oj::detail::runtime
@@ -0,0 +1,49 @@
+/**
+ * Break down the SLO of a run by priority decile and by slack,
+ * and count the missed tasks by cause.
+ *
+ * Usage: breakdown <dataset>...
+ * A dataset is either a file serialized by client.cpp,
+ * or the index (0 ~ 3) of a preset in testcase_array.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "breakdown.h"
+#include "src.hpp"
+
+namespace oj::detail::runtime {
+
+static void breakdown(const std::string &name) {
+    auto [desc, tasks] = load_dataset(name);
+
+    SloBreakdown slo;
+    const auto info = schedule_work(desc, std::move(tasks), slo);
+
+    std::cout << "dataset " << name
+              << " complete " << info.complete
+              << " total " << info.total << '\n';
+    slo.report(std::cout);
+    std::cout.flush();
+}
+
+} // namespace oj::detail::runtime
+
+signed main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <dataset>...\n";
+        return 1;
+    }
+    try {
+        for (int i = 1; i < argc; ++i) {
+            // Each dataset starts with a fresh scheduler.
+            oj::detail::runtime::run_isolated([&]() -> bool {
+                oj::detail::runtime::breakdown(argv[i]);
+                return true;
+            });
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,190 @@
+#pragma once
+#include "runtime.h"
+#include <array>
+#include <map>
+
+/**
+ * Breakdown of the SLO beyond ServiceInfo: by priority decile, by slack,
+ * and the cause of each miss. Each task is settled once it retires, so
+ * only the live tasks are kept in full, plus the totals per priority.
+ */
+namespace oj::detail::runtime {
+
+enum class Miss : std::size_t {
+    NeverLaunched,  // No container was ever launched
+    LateSave,       // Some saving finished after the deadline
+    Cancelled,      // Some container was cancelled, and no saving was late
+    Insufficient,   // Saved in time, but not enough progress
+    Count
+};
+
+inline constexpr std::array <std::string_view, std::size_t(Miss::Count)> kMissName = {
+    "never_launched", "late_save", "cancelled", "insufficient",
+};
+
+struct SloBreakdown : public Probe, public RuntimeListener {
+private:
+    struct Live {
+        priority_t  priority;
+        time_t      deadline;
+        time_t      slack;
+        bool        infeasible; // Even with no slack at all
+        bool        launched;
+        bool        cancelled;
+        bool        late_save;
+        bool        complete;
+    };
+
+    struct Settled {
+        std::size_t count;      // Of the tasks
+        ServiceInfo info;
+    };
+
+    /* Slack of 0 is bucket 0, and [2^(k-1), 2^k) is bucket k. */
+    static constexpr std::size_t kSlackBuckets = 64 + 1;
+
+    void settle(const Live &task) {
+        auto &same = settled[task.priority];
+        same.count += 1;
+        same.info.total += task.priority;
+        if (task.complete) same.info.complete += task.priority;
+
+        const auto bucket = std::size_t(std::bit_width(std::uint64_t(task.slack)));
+        auto &slack = task.infeasible ? infeasible : by_slack[bucket];
+        slack.total += task.priority;
+        if (task.complete) {
+            slack.complete += task.priority;
+        } else {
+            const auto miss =
+                !task.launched ? Miss::NeverLaunched :
+                task.late_save ? Miss::LateSave :
+                task.cancelled ? Miss::Cancelled : Miss::Insufficient;
+            misses[std::size_t(miss)] += 1;
+        }
+    }
+
+public:
+    void on_start(RuntimeManager &manager) {
+        const auto &cluster = manager.get_cluster();
+        max_core = EffectiveCore { cluster.cpu_count }.max();
+        overhead = cluster.start_up + cluster.saving;
+        manager.add_listener(*this);
+    }
+
+    /**
+     * Slack is the time to spare, if the task ran in a single container
+     * on all the CPUs, from its arrival on.
+     */
+    void on_arrive(task_id_t task_id, const Task &task) override {
+        const auto least = time_t(std::ceil(task.execution_time / max_core)) + overhead;
+        const auto window = task.deadline - task.launch_time;
+        live.emplace(task_id, Live {
+            .priority   = task.priority,
+            .deadline   = task.deadline,
+            .slack      = window >= least ? window - least : 0,
+            .infeasible = window < least,
+            .launched   = false,
+            .cancelled  = false,
+            .late_save  = false,
+            .complete   = false,
+        });
+    }
+
+    void on_launch(task_id_t task_id, cpu_id_t, time_t) override {
+        if (const auto iter = live.find(task_id); iter != live.end())
+            iter->second.launched = true;
+    }
+
+    void on_saved(task_id_t task_id, time_t time) override {
+        if (const auto iter = live.find(task_id); iter != live.end())
+            if (time > iter->second.deadline) iter->second.late_save = true;
+    }
+
+    void on_cancel(task_id_t task_id, time_t) override {
+        if (const auto iter = live.find(task_id); iter != live.end())
+            iter->second.cancelled = true;
+    }
+
+    void on_complete(task_id_t task_id) override {
+        live.at(task_id).complete = true;
+    }
+
+    void on_retire(task_id_t task_id) override {
+        const auto iter = live.find(task_id);
+        this->settle(iter->second);
+        live.erase(iter);
+    }
+
+    /* Tasks still holding CPUs at the end never retire. */
+    void on_finish(const RuntimeManager &) {
+        for (const auto &[task_id, task] : live) this->settle(task);
+        live.clear();
+    }
+
+    /**
+     * SLO of each priority decile, from the lowest priorities up. Tasks
+     * of the same priority are in the decile where the first of them
+     * falls, so a decile may be empty.
+     */
+    auto get_deciles() const -> std::array <ServiceInfo, 10> {
+        std::size_t count = 0;
+        for (const auto &[priority, same] : settled) count += same.count;
+
+        std::array <ServiceInfo, 10> result {};
+        std::size_t rank = 0;
+        for (const auto &[priority, same] : settled) {
+            auto &decile = result[rank * 10 / count];
+            decile.total += same.info.total;
+            decile.complete += same.info.complete;
+            rank += same.count;
+        }
+        return result;
+    }
+
+    auto get_misses(Miss miss) const -> std::size_t {
+        return misses[std::size_t(miss)];
+    }
+
+    void report(std::ostream &os) const {
+        auto print = [&](const ServiceInfo &info) {
+            const auto rate = info.total == 0 ? 1.0 : double(info.complete) / info.total;
+            os << " complete " << info.complete << " total " << info.total
+               << " slo " << rate << '\n';
+        };
+
+        os << std::fixed << std::setprecision(4);
+        const auto deciles = this->get_deciles();
+        for (std::size_t i = 0; i < deciles.size(); ++i) {
+            if (deciles[i].total == 0) continue;
+            os << "priority_decile " << i;
+            print(deciles[i]);
+        }
+
+        if (infeasible.total != 0) {
+            os << "slack infeasible";
+            print(infeasible);
+        }
+        for (std::size_t bucket = 0; bucket < kSlackBuckets; ++bucket) {
+            if (by_slack[bucket].total == 0) continue;
+            os << "slack [" << (std::uint64_t(1) << bucket >> 1)
+               << ", " << (std::uint64_t(1) << bucket) << ')';
+            print(by_slack[bucket]);
+        }
+
+        os << "missed";
+        for (std::size_t i = 0; i < misses.size(); ++i)
+            os << ' ' << kMissName[i] << ' ' << misses[i];
+        os << '\n';
+    }
+
+private:
+    double      max_core = 1;
+    time_t      overhead = 0;
+    std::unordered_map <task_id_t, Live> live;
+    std::map <priority_t, Settled> settled;     // By priority
+    std::array <ServiceInfo, kSlackBuckets> by_slack {};
+    ServiceInfo infeasible {};
+    std::array <std::size_t, std::size_t(Miss::Count)> misses {};
+};
+
+} // namespace oj::detail::runtime
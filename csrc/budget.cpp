@@ -0,0 +1,82 @@
+/**
+ * Run the scheduler under a time budget, and report the ticks over it.
+ *
+ * Usage: budget [-t us] [-r ms] [-f none|idle|save] <dataset>...
+ * -t and -r bound the time of schedule_tasks per tick and per run.
+ * With -f, the fallback schedules the rest of the run once over budget.
+ * A dataset is either a file serialized by client.cpp,
+ * or the index (0 ~ 3) of a preset in testcase_array.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "budget.h"
+#include "src.hpp"
+
+namespace oj::detail::runtime {
+
+struct Options {
+    TimeBudget          budget;
+    std::string_view    fallback = "none";
+};
+
+static auto make_fallback(std::string_view name) -> TickScheduler {
+    if (name == "none") return {};
+    if (name == "idle") return idle_fallback();
+    if (name == "save") return save_fallback();
+    panic <SystemException> ("Budget: Unknown fallback " + std::string(name));
+}
+
+static void budget(const std::string &name, const Options &options) {
+    auto [desc, tasks] = load_dataset(name);
+
+    BudgetedScheduler scheduler {
+        options.budget,
+        [](time_t time, std::vector <Task> list, const Description &desc) {
+            return schedule_tasks(time, std::move(list), desc);
+        },
+        make_fallback(options.fallback),
+    };
+    RuntimeManager manager { std::move(tasks), { .cpu_count = desc.cpu_count } };
+    const auto info = schedule_loop_with(desc, manager, scheduler);
+
+    std::cout << "dataset " << name
+              << " complete " << info.complete
+              << " total " << info.total << '\n';
+    scheduler.report(std::cout);
+    std::cout.flush();
+}
+
+} // namespace oj::detail::runtime
+
+signed main(int argc, char *argv[]) {
+    oj::detail::runtime::Options options;
+    std::vector <std::string> names;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "-t" && i + 1 < argc)
+            options.budget.per_tick = std::chrono::microseconds(std::stoull(argv[++i]));
+        else if (arg == "-r" && i + 1 < argc)
+            options.budget.per_run = std::chrono::milliseconds(std::stoull(argv[++i]));
+        else if (arg == "-f" && i + 1 < argc) options.fallback = argv[++i];
+        else names.emplace_back(arg);
+    }
+    if (names.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [-t us] [-r ms] [-f none|idle|save] <dataset>...\n";
+        return 1;
+    }
+
+    try {
+        for (const auto &name : names) {
+            // Each dataset starts with a fresh scheduler.
+            oj::detail::runtime::run_isolated([&]() -> bool {
+                oj::detail::runtime::budget(name, options);
+                return true;
+            });
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
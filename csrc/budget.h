@@ -0,0 +1,206 @@
+#pragma once
+#include "runtime.h"
+#include "handover.h"
+#include <chrono>
+#include <optional>
+#include <unordered_set>
+#include <utility>
+
+/**
+ * Time budgets of the scheduler, per tick and per run. A tick over budget
+ * is reported with its arrival batch, and the rest of the run may be
+ * handed to a fallback scheduler, instead of timing out as a whole.
+ * A call of schedule_tasks is never interrupted: it is only measured.
+ */
+namespace oj::detail::runtime {
+
+struct TimeBudget {
+    std::chrono::nanoseconds per_tick {};   // 0 for unlimited
+    std::chrono::nanoseconds per_run {};    // 0 for unlimited
+};
+
+struct Overrun {
+    enum class Kind { Tick, Run };
+
+    Kind                        kind;
+    time_t                      time;
+    std::chrono::nanoseconds    elapsed;    // In the tick
+    std::chrono::nanoseconds    spent;      // In the run, up to the tick
+    task_id_t                   first_id;   // Of the arrival batch
+    std::vector <Task>          arrivals;
+};
+
+/**
+ * @brief A scheduler which runs the primary one within the budget.
+ * Once over budget, if a fallback is given, the containers launched by
+ * the primary are saved, as branch.h does, and once all the CPUs are
+ * released, the fallback schedules through a Handover: it sees a run of
+ * its own from then, with the tasks which may still complete. Only the
+ * tasks before their deadlines are kept for it, so memory is bounded by
+ * those live.
+ */
+struct BudgetedScheduler {
+private:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t kPrune = 1024;
+
+    void record(Overrun::Kind kind, time_t time, clock::duration elapsed,
+        task_id_t first_id, const std::vector <Task> &arrivals) {
+        overrun_count += 1;
+        if (overruns.size() >= keep) return;
+        overruns.push_back(Overrun {
+            .kind       = kind,
+            .time       = time,
+            .elapsed    = elapsed,
+            .spent      = spent,
+            .first_id   = first_id,
+            .arrivals   = arrivals,
+        });
+    }
+
+    /* Keep the arrivals, and drop those past their deadlines now and then. */
+    void keep_live(time_t time, task_id_t first_id, const std::vector <Task> &list) {
+        for (task_id_t i = 0; i < list.size(); ++i)
+            live.emplace_back(first_id + i, list[i]);
+        if (live.size() < 2 * pruned) return;
+        std::erase_if(live, [time](const auto &pair) { return pair.second.deadline <= time; });
+        const auto &view = runtime_view();
+        std::erase_if(launched, [&view](task_id_t task_id) {
+            return view.get_task(task_id).state != WorkState::Launch;
+        });
+        pruned = std::max <std::size_t> (live.size(), kPrune);
+    }
+
+    /* Save the containers of the primary, and wait for their CPUs. */
+    auto drain() -> std::optional <std::vector <Policy>> {
+        const auto &view = runtime_view();
+        if (view.get_cpu_usage() == 0) return std::nullopt;
+        std::vector <Policy> savings;
+        for (const auto task_id : std::exchange(launched, {}))
+            if (view.get_task(task_id).state == WorkState::Launch)
+                savings.push_back(Saving { .task_id = task_id });
+        return savings;
+    }
+
+public:
+    /**
+     * @param primary The scheduler under budget.
+     * @param fallback Takes over once over budget, or none to keep on.
+     * @param keep At most so many overruns are kept, with their batches.
+     */
+    BudgetedScheduler(TimeBudget budget, TickScheduler primary,
+        TickScheduler fallback = {}, std::size_t keep = 16)
+        : budget(budget), primary(std::move(primary)), fallback(std::move(fallback)), keep(keep) {}
+
+    auto operator()(time_t time, std::vector <Task> list, const Description &desc)
+    -> std::vector <Policy> {
+        const auto first_id = arrived;
+        arrived += list.size();
+
+        if (handoff.has_value()) {
+            if (!takeover.has_value()) {
+                if (auto savings = this->drain()) {
+                    this->keep_live(time, first_id, list);
+                    return std::move(*savings);
+                }
+                takeover.emplace(std::move(fallback), std::exchange(live, {}), first_id);
+            }
+            return (*takeover)(time, std::move(list), desc);
+        }
+
+        // Copied before the clock starts, as the primary takes the list.
+        auto batch = list;
+        if (fallback) this->keep_live(time, first_id, list);
+
+        const auto start = clock::now();
+        auto policies = primary(time, std::move(list), desc);
+        const auto elapsed = clock::now() - start;
+        spent += elapsed;
+
+        if (fallback) {
+            for (const auto &policy : policies)
+                if (const auto *launch = std::get_if <Launch> (&policy))
+                    launched.insert(launch->task_id);
+        }
+
+        bool over = false;
+        if (budget.per_tick.count() != 0 && elapsed > budget.per_tick) {
+            this->record(Overrun::Kind::Tick, time, elapsed, first_id, batch);
+            over = true;
+        }
+        if (budget.per_run.count() != 0 && spent > budget.per_run && !run_exceeded) {
+            this->record(Overrun::Kind::Run, time, elapsed, first_id, batch);
+            run_exceeded = true;
+            over = true;
+        }
+        if (over && fallback) handoff = time;
+        return policies;
+    }
+
+    void report(std::ostream &os) const {
+        auto to_ms = [](auto duration) {
+            return std::chrono::duration <double, std::milli> (duration).count();
+        };
+        os << std::fixed << std::setprecision(3)
+           << "primary " << to_ms(spent) << "ms"
+           << " overruns " << overrun_count;
+        if (handoff.has_value()) os << " handoff " << *handoff;
+        os << '\n';
+        for (const auto &overrun : overruns) {
+            os << "  " << (overrun.kind == Overrun::Kind::Tick ? "tick" : "run")
+               << " at " << overrun.time
+               << " took " << to_ms(overrun.elapsed) << "ms"
+               << " spent " << to_ms(overrun.spent) << "ms"
+               << " arrivals " << overrun.arrivals.size();
+            if (!overrun.arrivals.empty())
+                os << " [" << overrun.first_id << ", "
+                   << overrun.first_id + overrun.arrivals.size() << ")";
+            os << '\n';
+        }
+    }
+
+    TimeBudget                  budget;
+    std::vector <Overrun>       overruns;
+    std::size_t                 overrun_count = 0;
+    std::optional <time_t>      handoff;    // The last tick of the primary
+    clock::duration             spent {};   // In the primary
+
+private:
+    TickScheduler               primary;
+    TickScheduler               fallback;
+    std::size_t                 keep;
+    bool                        run_exceeded = false;
+    task_id_t                   arrived = 0;
+    // Only with a fallback, until the handover.
+    std::vector <std::pair <task_id_t, Task>> live;
+    std::unordered_set <task_id_t> launched;    // By the primary, maybe running
+    std::size_t                 pruned = kPrune;    // Live ones at the last pruning
+    std::optional <Handover>    takeover;
+};
+
+/* A fallback which does nothing. */
+inline auto idle_fallback() -> TickScheduler {
+    return [](time_t, std::vector <Task>, const Description &) {
+        return std::vector <Policy> {};
+    };
+}
+
+/**
+ * @brief A fallback which saves the containers still running at the
+ * handoff, so their progress is kept, and launches nothing more.
+ * Its first call gets all the tasks it may see, as in a Handover.
+ */
+inline auto save_fallback() -> TickScheduler {
+    return [first = true](time_t, std::vector <Task> list, const Description &) mutable {
+        std::vector <Policy> policies;
+        if (!std::exchange(first, false)) return policies;
+        const auto &view = runtime_view();
+        for (task_id_t i = 0; i < list.size(); ++i)
+            if (view.get_task(i).state == WorkState::Launch)
+                policies.push_back(Saving { .task_id = i });
+        return policies;
+    };
+}
+
+} // namespace oj::detail::runtime
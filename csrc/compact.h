@@ -0,0 +1,99 @@
+#pragma once
+#include "runtime.h"
+#include <limits>
+#include <type_traits>
+
+/**
+ * Compact tasks, for keeping large task lists in memory.
+ * The width of each field is chosen at compile time from a Description,
+ * e.g. compact_task_t <oj::small> takes 8 bytes instead of 32.
+ * They are bridged to oj::Task at the API edge.
+ */
+namespace oj::detail::runtime {
+
+/* The narrowest unsigned type which holds the value. */
+template <std::uint64_t _Max>
+using uint_fit_t =
+    std::conditional_t <_Max <= std::numeric_limits <std::uint8_t>::max(), std::uint8_t,
+    std::conditional_t <_Max <= std::numeric_limits <std::uint16_t>::max(), std::uint16_t,
+    std::conditional_t <_Max <= std::numeric_limits <std::uint32_t>::max(), std::uint32_t,
+    std::uint64_t>>>;
+
+template <typename _Time, typename _Priority>
+struct CompactTask {
+    _Time       launch_time;
+    _Time       deadline;
+    _Time       execution_time;
+    _Priority   priority;
+};
+
+/**
+ * @brief The compact task type for a description. Times fit below the
+ * max deadline (a launch is always earlier) and the max execution time.
+ */
+template <Description _Desc>
+using compact_task_t = CompactTask <
+    uint_fit_t <std::max(_Desc.deadline_time.max, _Desc.execution_time_single.max)>,
+    uint_fit_t <_Desc.priority_single.max>>;
+
+template <typename _Time, typename _Priority>
+inline auto to_task(const CompactTask <_Time, _Priority> &task) -> Task {
+    return Task {
+        .launch_time    = task.launch_time,
+        .deadline       = task.deadline,
+        .execution_time = task.execution_time,
+        .priority       = task.priority,
+    };
+}
+
+template <typename _Compact>
+inline auto to_compact(const Task &task) -> _Compact {
+    using _Time     = decltype(_Compact::deadline);
+    using _Priority = decltype(_Compact::priority);
+    constexpr auto kTime     = std::numeric_limits <_Time>::max();
+    constexpr auto kPriority = std::numeric_limits <_Priority>::max();
+
+    if (task.deadline > kTime || task.execution_time > kTime || task.priority > kPriority)
+        panic <SystemException> ("Task does not fit in the compact type.");
+
+    return _Compact {
+        .launch_time    = _Time(task.launch_time),
+        .deadline       = _Time(task.deadline),
+        .execution_time = _Time(task.execution_time),
+        .priority       = _Priority(task.priority),
+    };
+}
+
+template <Description _Desc>
+inline auto compact_list(std::span <const Task> tasks)
+-> std::vector <compact_task_t <_Desc>> {
+    std::vector <compact_task_t <_Desc>> result;
+    result.reserve(tasks.size());
+    for (const auto &task : tasks)
+        result.push_back(to_compact <compact_task_t <_Desc>> (task));
+    return result;
+}
+
+template <typename _Time, typename _Priority>
+inline auto expand_list(const std::vector <CompactTask <_Time, _Priority>> &tasks)
+-> std::vector <Task> {
+    std::vector <Task> result;
+    result.reserve(tasks.size());
+    for (const auto &task : tasks)
+        result.push_back(to_task(task));
+    return result;
+}
+
+/* A source backed by a compact list, expanded one task at a time. */
+template <typename _Time, typename _Priority>
+inline auto make_source(std::vector <CompactTask <_Time, _Priority>> list) -> TaskSource {
+    if (!std::ranges::is_sorted(list, {}, &CompactTask <_Time, _Priority>::launch_time))
+        panic <SystemException> ("Task list is not sorted.");
+    auto tasks = std::make_shared <std::vector <CompactTask <_Time, _Priority>>> (std::move(list));
+    return [tasks, which = std::size_t(0)]() mutable -> std::optional <Task> {
+        if (which == tasks->size()) return std::nullopt;
+        return to_task((*tasks)[which++]);
+    };
+}
+
+} // namespace oj::detail::runtime
@@ -0,0 +1,233 @@
+#pragma once
+#include "runtime.h"
+#include "event.h"
+#include <deque>
+#include <coroutine>
+
+/**
+ * Coroutine-based schedulers.
+ * Each task is driven by a coroutine, which may co_await sleep_until(t)
+ * or cpu_available(k). A suspended coroutine costs nothing until the
+ * runtime resumes it from the event queue.
+ *
+ * Example:
+ *  auto control(Process::Context &ctx, task_id_t id, Task task) -> Process {
+ *      co_await ctx.cpu_available(1);
+ *      ctx.submit(Launch { 1, id });
+ *      co_await ctx.sleep_until(ctx.get_time() + kStartUp + task.execution_time);
+ *      ctx.submit(Saving { id });
+ *  }
+ */
+namespace oj::detail::runtime {
+
+struct Process {
+    struct promise_type {
+        auto get_return_object() -> Process {
+            return Process { handle::from_promise(*this) };
+        }
+        auto initial_suspend() noexcept -> std::suspend_never { return {}; }
+        auto final_suspend() noexcept -> std::suspend_always { return {}; }
+        void return_void() {}
+        void unhandled_exception() { throw; }
+    };
+
+    using handle = std::coroutine_handle <promise_type>;
+
+    struct Context;
+
+    explicit Process(handle coroutine) : coroutine(coroutine) {}
+    Process(Process &&other) noexcept : coroutine(std::exchange(other.coroutine, {})) {}
+    Process &operator=(Process &&other) noexcept {
+        std::swap(coroutine, other.coroutine);
+        return *this;
+    }
+    ~Process() { if (coroutine) coroutine.destroy(); }
+
+    auto done() const -> bool {
+        return coroutine.done();
+    }
+
+    void resume() {
+        coroutine.resume();
+    }
+
+private:
+    handle coroutine;
+};
+
+/**
+ * @brief The runtime of processes, as an EventScheduler.
+ * Processes waiting for CPUs are resumed in the order they wait,
+ * and a process is not resumed before all those ahead of it.
+ * CPUs freed by a Cancel may be launched again at once.
+ * Once the deadline of an incomplete task passes, its process is
+ * destroyed wherever it is suspended, and its container cancelled.
+ */
+struct Process::Context : public EventScheduler {
+public:
+    using Factory = std::function <Process (Context &, task_id_t, const Task &)>;
+
+    struct SleepAwaiter {
+        Context &context;
+        time_t   time;
+
+        auto await_ready() const -> bool { return time <= context.get_time(); }
+        void await_suspend(std::coroutine_handle <>) {
+            context.sleeping.emplace(time, context.current);
+            context.event->set_timer(time);
+        }
+        void await_resume() const {}
+    };
+
+    struct CPUAwaiter {
+        Context  &context;
+        cpu_id_t cpu_cnt;
+
+        auto await_ready() const -> bool {
+            return context.waiting.empty() && cpu_cnt <= context.get_free_cpu();
+        }
+        void await_suspend(std::coroutine_handle <>) {
+            context.waiting.emplace_back(cpu_cnt, context.current);
+        }
+        void await_resume() const {}
+    };
+
+    Context(const Description &desc, Factory factory)
+        : desc(desc), factory(std::move(factory)), task_count(0), launched(0) {}
+
+    /* Suspend until the given time. */
+    auto sleep_until(time_t time) -> SleepAwaiter {
+        return { *this, time };
+    }
+
+    /* Suspend until k CPUs are free, without launching on them. */
+    auto cpu_available(cpu_id_t cpu_cnt) -> CPUAwaiter {
+        if (cpu_cnt > desc.cpu_count)
+            panic("Process: CPU count exceeds the limit.");
+        return { *this, cpu_cnt };
+    }
+
+    auto get_time() const -> time_t {
+        return event->get_time();
+    }
+
+    /* Free CPUs now, with those launched and cancelled at this time. */
+    auto get_free_cpu() const -> cpu_id_t {
+        const auto &view = runtime_view();
+        auto result = desc.cpu_count - view.get_cpu_usage() + cancelled;
+        for (const auto &release : view.get_releases()) {
+            if (release.time > get_time()) break;
+            result += release.cpu_cnt;
+        }
+        return result - std::min(result, launched);
+    }
+
+    void submit(Policy policy) {
+        if (const auto *launch = std::get_if <Launch> (&policy)) {
+            launched += launch->cpu_cnt;
+        } else if (const auto *cancel = std::get_if <Cancel> (&policy)) {
+            // Unless counted free already, as its saving completes now.
+            const auto task = runtime_view().get_task(cancel->task_id);
+            if (task.state == WorkState::Launch
+            || (task.state == WorkState::Saving && task.time > get_time()))
+                cancelled += task.cpu_cnt;
+        }
+        event->submit(std::move(policy));
+    }
+
+    void on_arrival(EventContext &context, std::span <const Task> list) override {
+        this->enter(context);
+        for (const auto &task : list) {
+            const auto task_id = current = task_count++;
+            auto process = factory(*this, task_id, task);
+            if (!process.done()) processes.emplace(task_id, std::move(process));
+        }
+        this->leave();
+    }
+
+    void on_save_complete(EventContext &context, task_id_t, double) override {
+        this->enter(context);
+        this->leave();
+    }
+
+    void on_deadline_passed(EventContext &context, task_id_t task_id) override {
+        this->enter(context);
+        // Nothing saved from now on counts, so its container goes as well.
+        if (processes.erase(task_id) != 0
+        && runtime_view().get_task(task_id).state == WorkState::Launch)
+            this->submit(Cancel { .task_id = task_id });
+        this->leave();
+    }
+
+    void on_timer(EventContext &context, time_t time) override {
+        this->enter(context);
+        while (!sleeping.empty() && sleeping.top().first <= time) {
+            const auto task_id = sleeping.top().second;
+            sleeping.pop();
+            this->resume(task_id);
+        }
+        this->leave();
+    }
+
+private:
+    void enter(EventContext &context) {
+        if (event == nullptr || launched_time != context.get_time()) {
+            launched = cancelled = 0;
+            launched_time = context.get_time();
+        }
+        event = &context;
+    }
+
+    /* Resume those waiting for CPUs, and drop those destroyed. */
+    void leave() {
+        while (!waiting.empty()) {
+            const auto [cpu_cnt, task_id] = waiting.front();
+            if (processes.contains(task_id) && cpu_cnt > get_free_cpu()) break;
+            waiting.pop_front();
+            this->resume(task_id);
+        }
+    }
+
+    /* Processes destroyed may still be waiting or sleeping. */
+    void resume(task_id_t task_id) {
+        const auto iter = processes.find(task_id);
+        if (iter == processes.end()) return;
+        current = task_id;
+        iter->second.resume();
+        if (iter->second.done()) processes.erase(iter);
+    }
+
+    using Sleeping = std::pair <time_t, task_id_t>;
+    struct Later {
+        auto operator()(const Sleeping &x, const Sleeping &y) const -> bool {
+            return x.first > y.first;
+        }
+    };
+
+    const Description &desc;
+    Factory factory;
+    EventContext *event = nullptr;
+
+    task_id_t task_count;   // Count of arrived tasks
+    task_id_t current = 0;  // The task whose process is running
+    cpu_id_t  launched;     // CPUs launched at launched_time
+    cpu_id_t  cancelled = 0;    // CPUs freed by Cancel at launched_time
+    time_t    launched_time = 0;
+    std::unordered_map <task_id_t, Process> processes;  // Unfinished processes
+    std::priority_queue <Sleeping, std::vector <Sleeping>, Later> sleeping;
+    std::deque <std::pair <cpu_id_t, task_id_t>> waiting;
+};
+
+/**
+ * @brief Run a coroutine-based scheduler, where the factory starts
+ * a process for each task upon its arrival.
+ */
+[[maybe_unused]]
+static auto schedule_processes(
+    const Description &desc, std::vector <Task> tasks, Process::Context::Factory factory)
+-> ServiceInfo {
+    Process::Context context { desc, std::move(factory) };
+    return schedule_events(desc, std::move(tasks), context);
+}
+
+} // namespace oj::detail::runtime
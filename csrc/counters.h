@@ -0,0 +1,196 @@
+#pragma once
+#include "runtime.h"
+#include <array>
+#include <cerrno>
+#include <cstring>
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/**
+ * Hardware performance counters around schedule_tasks, by perf_event_open.
+ * Only user-space events of the calling thread are counted, so this works
+ * with the default perf_event_paranoid. Elsewhere, or when the kernel
+ * refuses, the counters are reported as unavailable.
+ */
+namespace oj::detail::runtime {
+
+enum class Counter : std::size_t {
+    Cycles, Instructions, CacheMisses, BranchMisses, Count
+};
+
+inline constexpr std::array <std::string_view, std::size_t(Counter::Count)> kCounterName = {
+    "cycles", "instructions", "cache_misses", "branch_misses",
+};
+
+using CounterValues = std::array <std::uint64_t, std::size_t(Counter::Count)>;
+
+/**
+ * @brief A group of counters, read all at once. Counters which the
+ * machine lacks (e.g. in a VM) are left out and read as zero.
+ */
+struct PerfCounters {
+#if defined(__linux__)
+private:
+    static auto open_event(std::uint64_t config, int group) -> int {
+        perf_event_attr attr {};
+        attr.size           = sizeof(attr);
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.config         = config;
+        attr.disabled       = group == -1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+        return ::syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+    }
+
+public:
+    PerfCounters() {
+        constexpr std::array <std::uint64_t, std::size_t(Counter::Count)> config = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+
+        for (std::size_t i = 0; i < config.size(); ++i) {
+            const auto fd = open_event(config[i], leader);
+            if (fd < 0) {
+                if (leader == -1) error = std::strerror(errno);
+                continue;
+            }
+            std::uint64_t id = 0;
+            ::ioctl(fd, PERF_EVENT_IOC_ID, &id);
+            if (leader == -1) leader = fd;
+            fds.push_back(fd);
+            ids[i] = id;
+            valid[i] = true;
+        }
+
+        if (leader != -1) {
+            ::ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ::ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+
+    ~PerfCounters() {
+        for (const auto fd : fds) ::close(fd);
+    }
+
+    PerfCounters(const PerfCounters &) = delete;
+    auto operator = (const PerfCounters &) -> PerfCounters & = delete;
+
+    auto available() const -> bool { return leader != -1; }
+
+    /* Why the counters are unavailable. */
+    auto get_error() const -> std::string_view { return error; }
+
+    auto is_valid(Counter counter) const -> bool {
+        return valid[std::size_t(counter)];
+    }
+
+    /* Current values, since the counters were opened. */
+    auto read() const -> CounterValues {
+        CounterValues result {};
+        if (leader == -1) return result;
+
+        // Layout of PERF_FORMAT_GROUP | PERF_FORMAT_ID: nr, then { value, id }.
+        std::array <std::uint64_t, 1 + 2 * std::size_t(Counter::Count)> buffer;
+        if (::read(leader, buffer.data(), sizeof(buffer)) <= 0) return result;
+
+        for (std::size_t j = 0; j < buffer[0]; ++j) {
+            const auto value = buffer[1 + 2 * j];
+            const auto id    = buffer[2 + 2 * j];
+            for (std::size_t i = 0; i < result.size(); ++i)
+                if (valid[i] && ids[i] == id) result[i] = value;
+        }
+        return result;
+    }
+
+private:
+    int                 leader = -1;
+    std::vector <int>   fds;
+    CounterValues       ids {};
+    std::array <bool, std::size_t(Counter::Count)> valid {};
+    std::string         error;
+#else
+    auto available() const -> bool { return false; }
+    auto get_error() const -> std::string_view { return "not supported on this platform"; }
+    auto is_valid(Counter) const -> bool { return false; }
+    auto read() const -> CounterValues { return {}; }
+#endif
+};
+
+/**
+ * @brief Counts the events of each schedule_tasks call, summed over
+ * buckets of bucket_width ticks.
+ */
+struct CounterProbe : public Probe {
+    struct Bucket {
+        time_t          first;
+        std::size_t     calls;
+        CounterValues   values;
+    };
+
+    explicit CounterProbe(time_t bucket_width) : bucket_width(std::max <time_t> (bucket_width, 1)) {}
+
+    void before_schedule(time_t) {
+        start = counters.read();
+    }
+
+    void after_schedule(time_t time, const std::vector <Policy> &) {
+        const auto stop = counters.read();
+        const auto first = time - time % bucket_width;
+        if (buckets.empty() || buckets.back().first != first)
+            buckets.push_back({ first, 0, {} });
+
+        auto &bucket = buckets.back();
+        bucket.calls += 1;
+        for (std::size_t i = 0; i < stop.size(); ++i)
+            bucket.values[i] += stop[i] - start[i];
+    }
+
+    auto get_buckets() const -> std::span <const Bucket> { return buckets; }
+
+    void report(std::ostream &os) const {
+        if (!counters.available()) {
+            os << "counters unavailable: " << counters.get_error() << '\n';
+            return;
+        }
+
+        auto print = [&](const CounterValues &values) {
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                if (!counters.is_valid(Counter(i))) continue;
+                os << ' ' << kCounterName[i] << ' ' << values[i];
+            }
+            const auto cycles = values[std::size_t(Counter::Cycles)];
+            const auto instructions = values[std::size_t(Counter::Instructions)];
+            if (cycles != 0 && instructions != 0)
+                os << " ipc " << double(instructions) / cycles;
+            os << '\n';
+        };
+
+        os << std::fixed << std::setprecision(3);
+        CounterValues total {};
+        for (const auto &bucket : buckets) {
+            os << "ticks [" << bucket.first << ", " << bucket.first + bucket_width
+               << ") calls " << bucket.calls;
+            print(bucket.values);
+            for (std::size_t i = 0; i < total.size(); ++i)
+                total[i] += bucket.values[i];
+        }
+        os << "total";
+        print(total);
+    }
+
+private:
+    PerfCounters            counters;
+    CounterValues           start {};
+    time_t                  bucket_width;
+    std::vector <Bucket>    buckets;
+};
+
+} // namespace oj::detail::runtime
@@ -47,9 +47,35 @@ struct Cancel {
     task_id_t   task_id;
 };
 
+enum class WorkState {
+    Free,
+    Launch,
+    Saving,
+};
+
+struct TaskView {
+    // A task saved after its deadline stays Saving until cancelled.
+    WorkState   state;
+    // CPUs held by the container, 0 if free.
+    cpu_id_t    cpu_cnt;
+    // When launched if Launch, when the saving completes if Saving.
+    time_t      time;
+    // Progress saved before the deadline so far.
+    // A free task past its deadline may be forgotten, with no progress.
+    double      progress;
+    // Whether it can no longer complete, even on all the CPUs.
+    bool        infeasible;
+};
+
+struct Release {
+    // The CPUs can be launched again from this time.
+    time_t      time;
+    cpu_id_t    cpu_cnt;
+};
+
 struct PublicInformation {
     static constexpr time_t   kMaxTime  = 1e8;
-    static constexpr cpu_id_t kCPUCount = 114;
+    static constexpr cpu_id_t kCPUCount = 114; // Default, see Description::cpu_count.
     static constexpr time_t   kStartUp  = 2;
     static constexpr time_t   kSaving   = 2;
     static constexpr double   kAccel    = 0.75;
@@ -0,0 +1,156 @@
+#pragma once
+#include "runtime.h"
+#include <utility>
+
+/* The runtime of event-driven schedulers, see EventScheduler. */
+namespace oj::detail::runtime {
+
+struct EventDriver : public EventContext {
+private:
+    static constexpr time_t kNever = ~time_t(0);
+
+    using Deadline = std::pair <time_t, task_id_t>;
+    template <typename _Tp>
+    using MinHeap = std::priority_queue <_Tp, std::vector <_Tp>, std::greater <>>;
+
+    /* The earliest time when something happens, or kNever. */
+    auto next_event() -> time_t {
+        const auto now = manager.get_time();
+        auto result = kNever;
+
+        if (const auto time = manager.get_next_arrival())
+            result = std::min(result, *time);
+        if (const auto time = manager.get_next_release(now))
+            result = std::min(result, *time);
+
+        // Completed tasks are dropped lazily.
+        while (!deadlines.empty() && !pending.contains(deadlines.top().second))
+            deadlines.pop();
+        if (!deadlines.empty())
+            result = std::min(result, deadlines.top().first + 1);
+
+        if (!timers.empty())
+            result = std::min(result, timers.top());
+
+        return result;
+    }
+
+    void dispatch(std::vector <Task> arrivals) {
+        const auto now = manager.get_time();
+
+        for (const auto &[task_id, progress] : manager.get_completing(now)) {
+            const auto iter = pending.find(task_id);
+            if (iter != pending.end() && time_t(progress) >= iter->second)
+                pending.erase(iter);
+            scheduler.on_save_complete(*this, task_id, progress);
+        }
+
+        while (!deadlines.empty() && deadlines.top().first < now) {
+            const auto task_id = deadlines.top().second;
+            deadlines.pop();
+            if (pending.erase(task_id) != 0)
+                scheduler.on_deadline_passed(*this, task_id);
+        }
+
+        if (!arrivals.empty()) {
+            for (const auto &task : arrivals) {
+                pending.emplace(task_count, task.execution_time);
+                deadlines.emplace(task.deadline, task_count);
+                task_count += 1;
+            }
+            scheduler.on_arrival(*this, arrivals);
+        }
+
+        bool timer = false;
+        while (!timers.empty() && timers.top() == now) {
+            timers.pop();
+            timer = true;
+        }
+        if (timer) scheduler.on_timer(*this, now);
+
+        manager.work(std::exchange(policies, {}));
+    }
+
+public:
+    EventDriver(const Description &desc, RuntimeManager &manager, EventScheduler &scheduler)
+        : desc(desc), manager(manager), scheduler(scheduler), task_count(0) {}
+
+    auto get_time() const -> time_t override {
+        return manager.get_time();
+    }
+
+    void submit(Policy policy) override {
+        policies.push_back(std::move(policy));
+    }
+
+    void set_timer(time_t time) override {
+        if (time <= manager.get_time())
+            panic("Timer: Time should be in the future.");
+        timers.push(time);
+    }
+
+    auto run() -> ServiceInfo {
+        const ViewGuard guard { manager };
+
+        timers.push(0);
+        while (true) {
+            const auto time = this->next_event();
+            if (time > desc.deadline_time.max) break;
+            this->dispatch(manager.skip_to(time));
+        }
+
+        manager.skip_to(desc.deadline_time.max + 1);
+
+        return manager.get_service_info();
+    }
+
+private:
+    const Description   &desc;
+    RuntimeManager      &manager;
+    EventScheduler      &scheduler;
+
+    task_id_t task_count;                   // Count of arrived tasks
+    std::vector <Policy> policies;          // Submitted at this time
+    MinHeap <time_t> timers;                // Timers set by the scheduler
+    MinHeap <Deadline> deadlines;           // Deadlines of pending tasks
+    std::unordered_map <task_id_t, time_t> pending; // Incomplete tasks -> work
+};
+
+/**
+ * @brief An EventScheduler which calls the schedule_tasks in interface.h
+ * at every tick, with the tasks that arrived at that tick.
+ */
+struct TickAdapter : public EventScheduler {
+    explicit TickAdapter(const Description &desc) : desc(desc) {}
+
+    void on_arrival(EventContext &, std::span <const Task> list) override {
+        arrivals.insert(arrivals.end(), list.begin(), list.end());
+    }
+
+    void on_timer(EventContext &context, time_t time) override {
+        for (auto &policy : schedule_tasks(time, std::exchange(arrivals, {}), desc))
+            context.submit(std::move(policy));
+        if (time < desc.deadline_time.max)
+            context.set_timer(time + 1);
+    }
+
+private:
+    const Description &desc;
+    std::vector <Task> arrivals;
+};
+
+[[maybe_unused]]
+static auto schedule_events(const Description &desc, TaskSource source, EventScheduler &scheduler)
+-> ServiceInfo {
+    RuntimeManager manager { std::move(source), { .cpu_count = desc.cpu_count } };
+    return EventDriver { desc, manager, scheduler }.run();
+}
+
+[[maybe_unused]]
+static auto schedule_events(const Description &desc, std::vector <Task> tasks, EventScheduler &scheduler)
+-> ServiceInfo {
+    RuntimeManager manager { std::move(tasks), { .cpu_count = desc.cpu_count } };
+    return EventDriver { desc, manager, scheduler }.run();
+}
+
+} // namespace oj::detail::runtime
@@ -0,0 +1,136 @@
+#pragma once
+#include "runtime.h"
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Handing the rest of a run over to another scheduler, e.g. a fallback
+ * or a counterfactual branch. The scheduler sees the rest as a run of its
+ * own: time starts from 0 at the handover, and only the tasks which may
+ * still complete are given, with IDs from 0 and their remaining work.
+ * The runtime view is translated the same way.
+ */
+namespace oj::detail::runtime {
+
+struct Handover : public RuntimeView {
+private:
+    /* Earlier tasks are looked up, and later ones are offset. */
+    auto to_global(task_id_t task_id) const -> task_id_t {
+        if (task_id >= global.size() + (next_id - first_id))
+            panic("Handover: Task ID out of range.");
+        if (task_id < global.size()) return global[task_id];
+        return first_id + (task_id - global.size());
+    }
+
+    auto to_local(task_id_t task_id) const -> std::optional <task_id_t> {
+        if (task_id >= first_id) return global.size() + (task_id - first_id);
+        const auto iter = local.find(task_id);
+        if (iter == local.end()) return std::nullopt;
+        return iter->second;
+    }
+
+    auto shift(time_t time) const -> time_t {
+        return time < origin ? 0 : time - origin;
+    }
+
+    /* Give the task to the scheduler, with the progress already saved. */
+    void add(const Task &task, double progress, std::vector <Task> &list) {
+        const auto remain = std::ceil(double(task.execution_time) - progress);
+        list.push_back(Task {
+            .launch_time    = this->shift(task.launch_time),
+            .deadline       = task.deadline - origin,
+            .execution_time = std::max <time_t> (1, time_t(std::max(remain, 0.0))),
+            .priority       = task.priority,
+        });
+    }
+
+public:
+    /**
+     * @param earlier Tasks arrived before the handover, with their IDs in
+     * the runtime. Those which can no longer complete are left out, and so
+     * are those not free, so drain the containers before the handover.
+     * @param next_id The ID in the runtime of the next task to arrive.
+     */
+    Handover(TickScheduler scheduler, std::vector <std::pair <task_id_t, Task>> earlier, task_id_t next_id)
+        : scheduler(std::move(scheduler)), earlier(std::move(earlier)),
+          first_id(next_id), next_id(next_id) {}
+
+    auto operator()(time_t time, std::vector <Task> list, const Description &desc)
+    -> std::vector <Policy> {
+        std::vector <Task> given;
+        if (view == nullptr) {
+            // The first call, where the handover happens.
+            view = &runtime_view();
+            origin = time;
+            for (const auto &[task_id, task] : std::exchange(earlier, {})) {
+                if (task.deadline <= origin) continue;
+                const auto state = view->get_task(task_id);
+                if (state.state != WorkState::Free || state.infeasible
+                || state.progress >= task.execution_time) continue;
+                local.emplace(task_id, global.size());
+                global.push_back(task_id);
+                base.push_back(state.progress);
+                this->add(task, state.progress, given);
+            }
+        }
+        for (const auto &task : list)
+            this->add(task, 0, given);
+        next_id += list.size();
+
+        auto shifted = desc;
+        shifted.deadline_time = {
+            .min = this->shift(std::max(desc.deadline_time.min, origin + 1)),
+            .max = this->shift(desc.deadline_time.max),
+        };
+
+        std::vector <Policy> policies;
+        {
+            const ViewGuard guard { *this };
+            policies = scheduler(time - origin, std::move(given), shifted);
+        }
+        for (auto &policy : policies)
+            std::visit([this](auto &command) { command.task_id = this->to_global(command.task_id); }, policy);
+        return policies;
+    }
+
+    auto get_cpu_usage() const -> cpu_id_t override {
+        return view->get_cpu_usage();
+    }
+
+    auto get_task(task_id_t task_id) const -> TaskView override {
+        auto result = view->get_task(this->to_global(task_id));
+        if (result.state != WorkState::Free) result.time = this->shift(result.time);
+        if (task_id < base.size())
+            result.progress = std::max(result.progress - base[task_id], 0.0);
+        return result;
+    }
+
+    auto get_releases() const -> std::vector <Release> override {
+        auto result = view->get_releases();
+        for (auto &release : result) release.time = this->shift(release.time);
+        return result;
+    }
+
+    auto get_infeasible() const -> std::vector <task_id_t> override {
+        std::vector <task_id_t> result;
+        for (const auto task_id : view->get_infeasible()) {
+            if (const auto which = this->to_local(task_id)) result.push_back(*which);
+        }
+        return result;
+    }
+
+private:
+    TickScheduler                               scheduler;
+    std::vector <std::pair <task_id_t, Task>>   earlier;
+    task_id_t                                   first_id;   // Of the first later task
+    task_id_t                                   next_id;
+    const RuntimeView                          *view = nullptr;
+    time_t                                      origin = 0;
+    // Only for the earlier tasks, so memory is bounded by those live then.
+    std::vector <task_id_t>                     global; // By the ID given
+    std::vector <double>                        base;   // Progress saved before
+    std::unordered_map <task_id_t, task_id_t>   local;  // By the ID in the runtime
+};
+
+} // namespace oj::detail::runtime
@@ -0,0 +1,147 @@
+#pragma once
+#include "runtime.h"
+#include <span>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/* Helpers for tools that run the same scheduler many times. */
+namespace oj::detail::runtime {
+
+/**
+ * @brief A job running in a forked child process.
+ * Schedulers keep their state in globals, so each run must start from
+ * a fresh copy of the process. The result is sent back through a pipe,
+ * hence it must be trivially copyable.
+ */
+template <typename _Tp>
+struct Isolated {
+    static_assert(std::is_trivially_copyable_v <_Tp>);
+    pid_t   pid;
+    int     fd;
+};
+
+template <typename _Tp>
+struct IsolatedResult {
+    bool    ok;
+    _Tp     value;
+    char    message[256];
+};
+
+template <typename _Fn, typename _Tp = std::invoke_result_t <_Fn>>
+auto spawn_isolated(_Fn &&fn) -> Isolated <_Tp> {
+    int fds[2];
+    if (::pipe(fds) != 0)
+        panic <SystemException> ("Isolated: pipe failed.");
+
+    // Otherwise the child flushes a copy of what is buffered.
+    std::cout.flush();
+    std::cerr.flush();
+
+    const auto pid = ::fork();
+    if (pid < 0)
+        panic <SystemException> ("Isolated: fork failed.");
+
+    if (pid == 0) {
+        ::close(fds[0]);
+        IsolatedResult <_Tp> result {};
+        try {
+            result.value = fn();
+            result.ok = true;
+        } catch (const std::exception &e) {
+            std::strncpy(result.message, e.what(), sizeof(result.message) - 1);
+        } catch (...) {
+            std::strncpy(result.message, "Unknown error.", sizeof(result.message) - 1);
+        }
+        const auto *data = std::bit_cast <const char *> (&result);
+        for (std::size_t done = 0; done < sizeof(result);) {
+            const auto size = ::write(fds[1], data + done, sizeof(result) - done);
+            if (size <= 0) break;
+            done += size;
+        }
+        std::cout.flush();
+        ::_exit(result.ok ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    ::close(fds[1]);
+    return { .pid = pid, .fd = fds[0] };
+}
+
+/* Wait for the child. Its exception is rethrown as a SystemException. */
+template <typename _Tp>
+auto join_isolated(Isolated <_Tp> child) -> _Tp {
+    IsolatedResult <_Tp> result {};
+    auto *data = std::bit_cast <char *> (&result);
+    std::size_t done = 0;
+    while (done < sizeof(result)) {
+        const auto size = ::read(child.fd, data + done, sizeof(result) - done);
+        if (size <= 0) break;
+        done += size;
+    }
+    ::close(child.fd);
+    ::waitpid(child.pid, nullptr, 0);
+
+    if (done != sizeof(result))
+        panic <SystemException> ("Isolated: child crashed.");
+    if (!result.ok)
+        panic <SystemException> (result.message);
+    return result.value;
+}
+
+template <typename _Fn>
+auto run_isolated(_Fn &&fn) -> std::invoke_result_t <_Fn> {
+    return join_isolated(spawn_isolated(std::forward <_Fn> (fn)));
+}
+
+/* Run the jobs, at most `parallel` children at a time, in order. */
+template <typename _Tp>
+auto run_parallel(std::span <const std::function <_Tp ()>> jobs, std::size_t parallel)
+-> std::vector <_Tp> {
+    parallel = std::max <std::size_t> (parallel, 1);
+
+    std::vector <Isolated <_Tp>> children;
+    std::vector <_Tp> results;
+    children.reserve(jobs.size());
+    results.reserve(jobs.size());
+
+    for (const auto &job : jobs) {
+        if (children.size() - results.size() == parallel)
+            results.push_back(join_isolated(children[results.size()]));
+        children.push_back(spawn_isolated(job));
+    }
+
+    while (results.size() < children.size())
+        results.push_back(join_isolated(children[results.size()]));
+
+    return results;
+}
+
+/* The SLO rate of a run. */
+inline auto slo_rate(const ServiceInfo &info) -> double {
+    if (info.total == 0) return 1;
+    return double(info.complete) / info.total;
+}
+
+/**
+ * @brief Load a task set, either a serialized file made by client.cpp,
+ * or the index of a preset in testcase_array, generated by generate_tasks.
+ */
+[[maybe_unused]]
+static auto load_dataset(const std::string &name)
+-> std::pair <Description, std::vector <Task>> {
+    constexpr auto kPresets = std::size(testcase_array);
+    if (name.size() == 1 && std::size_t(name[0] - '0') < kPresets) {
+        const auto &desc = testcase_array[name[0] - '0'];
+        return { desc, generate_work(desc) };
+    }
+
+    std::ifstream file { name, std::ios::binary };
+    if (!file.is_open())
+        panic <SystemException> ("Cannot open dataset " + name);
+    auto [header, tasks] = deserialize(file);
+    return { header.description, std::move(tasks) };
+}
+
+} // namespace oj::detail::runtime
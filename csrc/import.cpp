@@ -0,0 +1,77 @@
+/**
+ * Convert a public cluster trace into a task set, serialized the same as
+ * by client.cpp, so that it may be used as a dataset by the other tools.
+ *
+ * Usage: import [-f alibaba|borg] [-u units] [-s slack] [-c cpus] [-n max]
+ *               [-H lines] <input.csv> <output>
+ * -f   The table: Alibaba 2018 batch_task, or Google 2011 task_events.
+ * -u   Trace time units in a tick (default 1, e.g. 1000000 for Borg).
+ * -s   The deadline is the execution time on one CPU times the slack,
+ *      after the overhead (default 2).
+ * -c   The CPU count of the description (default 64).
+ * -n   Stop after so many tasks.
+ * -H   Header lines to skip.
+ * The service info in the header is left zero, as no scheduler is run.
+ */
+#include "runtime.h"
+#include "import.h"
+
+signed main(int argc, char *argv[]) {
+    using namespace oj::detail::runtime;
+
+    ImportFormat format = alibaba_format();
+    ImportOptions options;
+    std::size_t header_lines = 0;
+    std::vector <std::string> paths;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            if (arg.size() == 2 && arg[0] == '-' && i + 1 == argc)
+                throw std::invalid_argument("Missing value.");
+            if (arg == "-f") {
+                const std::string_view name = argv[++i];
+                if (name == "alibaba") format = alibaba_format();
+                else if (name == "borg") format = borg_format();
+                else throw std::invalid_argument("Unknown format.");
+            }
+            else if (arg == "-u") options.units_per_tick = std::stod(argv[++i]);
+            else if (arg == "-s") options.slack = std::stod(argv[++i]);
+            else if (arg == "-c") options.cpu_count = std::stoull(argv[++i]);
+            else if (arg == "-n") options.max_tasks = std::stoull(argv[++i]);
+            else if (arg == "-H") header_lines = std::stoull(argv[++i]);
+            else paths.emplace_back(arg);
+        }
+        if (paths.size() != 2) throw std::invalid_argument("Missing paths.");
+    } catch (const std::exception &) {
+        std::cerr << "Usage: " << argv[0] << " [-f alibaba|borg] [-u units] [-s slack]"
+                     " [-c cpus] [-n max] [-H lines] <input.csv> <output>\n";
+        return 1;
+    }
+    format.header_lines = header_lines;
+
+    try {
+        ImportStats stats;
+        const auto [desc, tasks] = import_trace(paths[0], format, options, &stats);
+
+        std::ofstream file { paths[1], std::ios::binary };
+        if (!file.is_open())
+            panic <SystemException> ("Import: Cannot write " + paths[1]);
+        serialize(file, tasks, desc, {});
+
+        std::cout << "rows " << stats.rows
+                  << " tasks " << tasks.size()
+                  << " malformed " << stats.malformed
+                  << " unmatched " << stats.unmatched
+                  << " clamped " << stats.clamped << '\n'
+                  << "horizon " << desc.deadline_time.max
+                  << " execution " << desc.execution_time_single.min
+                  << " ~ " << desc.execution_time_single.max
+                  << " priority " << desc.priority_single.min
+                  << " ~ " << desc.priority_single.max << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,330 @@
+#pragma once
+#include "runtime.h"
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <unordered_map>
+
+/**
+ * Import public cluster traces as task sets. A CSV is parsed a chunk at a
+ * time, and each job becomes a task: its arrival the launch time, its run
+ * time the execution time, and a column of it the priority. The deadline
+ * is the execution time on one CPU times the slack, after the overhead.
+ * Where the trace tells when a job is scheduled, the run time starts
+ * from there, so that the time it queued is not counted as work.
+ */
+namespace oj::detail::runtime {
+
+struct ImportFormat {
+    enum class Mode {
+        Interval,   // One row per job, with its start and end time
+        Event,      // Rows of submit, schedule and finish events, by key
+    };
+
+    static constexpr std::size_t kNone = std::size_t(-1);
+
+    Mode                        mode;
+    char                        separator       = ',';
+    std::size_t                 header_lines    = 0;
+    std::size_t                 time_column;            // The start, or the event time
+    std::size_t                 end_column      = kNone;    // Interval only
+    std::size_t                 key_column      = kNone;    // Event only
+    std::size_t                 key2_column     = kNone;    // Event only, if any
+    std::size_t                 event_column    = kNone;    // Event only
+    std::uint64_t               submit_event    = 0;
+    std::uint64_t               schedule_event  = kNone;    // If any
+    std::uint64_t               finish_event    = 0;
+    std::vector <std::uint64_t> drop_events     = {};   // Ending a job with no task
+    std::size_t                 priority_column;
+    double                      priority_offset = 0;
+    double                      priority_scale  = 1;
+};
+
+/* The batch_task table of Alibaba cluster-trace-v2018, times in seconds. */
+inline auto alibaba_format() -> ImportFormat {
+    return ImportFormat {
+        .mode               = ImportFormat::Mode::Interval,
+        .time_column        = 5,    // start_time
+        .end_column         = 6,    // end_time
+        .priority_column    = 7,    // plan_cpu, 100 for a core
+        .priority_scale     = 0.01,
+    };
+}
+
+/* The task_events table of Google cluster-data-2011, times in microseconds. */
+inline auto borg_format() -> ImportFormat {
+    return ImportFormat {
+        .mode               = ImportFormat::Mode::Event,
+        .time_column        = 0,    // timestamp
+        .key_column         = 2,    // job ID
+        .key2_column        = 3,    // task index
+        .event_column       = 5,    // event type
+        .submit_event       = 0,    // SUBMIT
+        .schedule_event     = 1,    // SCHEDULE
+        .finish_event       = 4,    // FINISH
+        .drop_events        = { 2, 3, 5, 6 },   // EVICT, FAIL, KILL, LOST
+        .priority_column    = 8,    // priority, 0 ~ 11
+        .priority_offset    = 1,
+    };
+}
+
+struct ImportOptions {
+    double          units_per_tick  = 1;    // Trace time units in a tick
+    double          slack           = 2;
+    cpu_id_t        cpu_count       = 64;
+    std::size_t     max_tasks       = std::size_t(-1);
+};
+
+struct ImportStats {
+    std::size_t     rows        = 0;
+    std::size_t     malformed   = 0;    // Missing or bad fields
+    std::size_t     unmatched   = 0;    // Finished before submitted or scheduled, or dropped
+    std::size_t     clamped     = 0;    // Deadline raised to be feasible
+};
+
+/**
+ * @brief Turns rows into tasks, fed a chunk of the file at a time. Times
+ * are shifted so that the first arrival is at tick 0.
+ */
+struct TraceImporter {
+private:
+    static constexpr time_t kOverhead = PublicInformation::kStartUp + PublicInformation::kSaving;
+
+    /* A submitted job, waiting for its finish. */
+    struct Submitted {
+        double                  time;
+        double                  priority;
+        std::optional <double>  scheduled;  // When it last started to run
+    };
+
+    struct KeyHash {
+        auto operator()(const std::pair <std::uint64_t, std::uint64_t> &key) const -> std::size_t {
+            return std::hash <std::uint64_t> {} (key.first * 0x9E3779B97F4A7C15 ^ key.second);
+        }
+    };
+
+    template <typename _Tp>
+    static auto parse(std::string_view field, _Tp &value) -> bool {
+        const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+        return error == std::errc {} && end == field.data() + field.size() && !field.empty();
+    }
+
+    /* A task arriving at the time, which ran for the duration. */
+    void add_task(double arrival, double duration, double priority) {
+        const auto launch = std::floor(arrival / options.units_per_tick);
+        const auto length = std::ceil(duration / options.units_per_tick);
+        if (!(launch >= 0 && length >= 0 && launch + length < 0x1p52)) {
+            stats.malformed += 1;
+            return;
+        }
+
+        const auto execution_time = std::max <time_t> (1, time_t(length));
+        // Same bound as check_tasks, with the fraction rounded up.
+        const auto least = time_t(execution_time / max_core) + 1;
+        auto budget = time_t(std::ceil(execution_time * options.slack));
+        if (budget < least) {
+            budget = least;
+            stats.clamped += 1;
+        }
+
+        const auto weight = std::llround((priority + format.priority_offset) * format.priority_scale);
+        tasks.push_back(Task {
+            .launch_time    = time_t(launch),
+            .deadline       = time_t(launch) + kOverhead + budget,
+            .execution_time = execution_time,
+            .priority       = priority_t(std::max <long long> (weight, 1)),
+        });
+    }
+
+    void add_row(std::string_view line) {
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty()) return;
+        stats.rows += 1;
+
+        fields.clear();
+        for (std::size_t begin = 0;;) {
+            const auto end = line.find(format.separator, begin);
+            fields.push_back(line.substr(begin, end - begin));
+            if (end == line.npos || fields.size() > last_column) break;
+            begin = end + 1;
+        }
+        if (fields.size() <= last_column) {
+            stats.malformed += 1;
+            return;
+        }
+
+        double time, priority;
+        if (!parse(fields[format.time_column], time) || !parse(fields[format.priority_column], priority)) {
+            stats.malformed += 1;
+            return;
+        }
+
+        if (format.mode == ImportFormat::Mode::Interval) {
+            double end;
+            if (!parse(fields[format.end_column], end) || end < time) {
+                stats.malformed += 1;
+                return;
+            }
+            return this->add_task(time, end - time, priority);
+        }
+
+        std::uint64_t event, key, key2 = 0;
+        if (!parse(fields[format.event_column], event) || !parse(fields[format.key_column], key)
+        || (format.key2_column != ImportFormat::kNone && !parse(fields[format.key2_column], key2))) {
+            stats.malformed += 1;
+            return;
+        }
+
+        if (event == format.submit_event) {
+            // A job submitted again starts anew.
+            submitted.insert_or_assign({ key, key2 }, Submitted { time, priority, std::nullopt });
+        } else if (event == format.schedule_event) {
+            // Those submitted before the trace begins are left out.
+            const auto iter = submitted.find({ key, key2 });
+            if (iter != submitted.end()) iter->second.scheduled = time;
+        } else if (event == format.finish_event) {
+            const auto iter = submitted.find({ key, key2 });
+            if (iter == submitted.end()) {
+                stats.unmatched += 1;
+                return;
+            }
+            const auto job = iter->second;
+            submitted.erase(iter);
+            const bool scheduling = format.schedule_event != ImportFormat::kNone;
+            if (scheduling && !job.scheduled.has_value()) {
+                stats.unmatched += 1;
+                return;
+            }
+            const auto start = job.scheduled.value_or(job.time);
+            if (start < job.time || time < start) {
+                stats.malformed += 1;
+                return;
+            }
+            this->add_task(job.time, time - start, job.priority);
+        } else if (std::ranges::find(format.drop_events, event) != format.drop_events.end()) {
+            stats.unmatched += submitted.erase({ key, key2 });
+        }
+    }
+
+public:
+    TraceImporter(ImportFormat format, const ImportOptions &options)
+        : format(std::move(format)), options(options),
+          max_core(std::pow(options.cpu_count, PublicInformation::kAccel)) {
+        if (options.cpu_count == 0 || !(options.units_per_tick > 0) || !(options.slack > 0))
+            panic <SystemException> ("Import: CPU count, unit and slack should be positive.");
+        const auto &f = this->format;
+        last_column = std::max(f.time_column, f.priority_column);
+        for (const auto column : { f.end_column, f.key_column, f.key2_column, f.event_column })
+            if (column != ImportFormat::kNone) last_column = std::max(last_column, column);
+        skip_lines = f.header_lines;
+    }
+
+    /* Whether it wants more rows. */
+    auto hungry() const -> bool {
+        return tasks.size() < options.max_tasks;
+    }
+
+    /* Feed a chunk, whose last line may be cut anywhere. */
+    void feed(std::string_view chunk) {
+        while (!chunk.empty() && this->hungry()) {
+            const auto newline = chunk.find('\n');
+            if (newline == chunk.npos) {
+                partial.append(chunk);
+                return;
+            }
+            auto line = chunk.substr(0, newline);
+            chunk.remove_prefix(newline + 1);
+            if (!partial.empty()) {
+                partial.append(line);
+                line = partial;
+            }
+            if (skip_lines != 0) skip_lines -= 1;
+            else this->add_row(line);
+            partial.clear();
+        }
+    }
+
+    /**
+     * @brief The tasks, sorted by launch time, and the tightest
+     * description they satisfy. Unfinished jobs are left out.
+     */
+    auto finish() -> std::pair <Description, std::vector <Task>> {
+        if (!partial.empty() && skip_lines == 0 && this->hungry())
+            this->add_row(std::exchange(partial, {}));
+        stats.unmatched += submitted.size();
+        submitted.clear();
+        if (tasks.size() > options.max_tasks) tasks.resize(options.max_tasks);
+        if (tasks.empty())
+            panic <SystemException> ("Import: No task in the trace.");
+
+        std::ranges::stable_sort(tasks, {}, &Task::launch_time);
+        const auto origin = tasks.front().launch_time;
+
+        Description desc {
+            .cpu_count              = options.cpu_count,
+            .task_count             = tasks.size(),
+            .deadline_time          = { .min = time_t(-1), .max = 0 },
+            .execution_time_single  = { .min = time_t(-1), .max = 0 },
+            .execution_time_sum     = { .min = 0, .max = 0 },
+            .priority_single        = { .min = priority_t(-1), .max = 0 },
+            .priority_sum           = { .min = 0, .max = 0 },
+        };
+        for (auto &task : tasks) {
+            task.launch_time -= origin;
+            task.deadline -= origin;
+            desc.deadline_time.min = std::min(desc.deadline_time.min, task.deadline);
+            desc.deadline_time.max = std::max(desc.deadline_time.max, task.deadline);
+            desc.execution_time_single.min = std::min(desc.execution_time_single.min, task.execution_time);
+            desc.execution_time_single.max = std::max(desc.execution_time_single.max, task.execution_time);
+            desc.priority_single.min = std::min(desc.priority_single.min, task.priority);
+            desc.priority_single.max = std::max(desc.priority_single.max, task.priority);
+            desc.execution_time_sum.max += task.execution_time;
+            desc.priority_sum.max += task.priority;
+        }
+        desc.execution_time_sum.min = desc.execution_time_sum.max;
+        desc.priority_sum.min = desc.priority_sum.max;
+
+        check_tasks(tasks, desc);
+        return { desc, std::move(tasks) };
+    }
+
+    ImportStats     stats;
+
+private:
+    ImportFormat                format;
+    ImportOptions               options;
+    double                      max_core;
+    std::size_t                 last_column;
+    std::size_t                 skip_lines;
+    std::string                 partial;    // A line cut by the chunk
+    std::vector <std::string_view> fields;
+    std::vector <Task>          tasks;
+    std::unordered_map <std::pair <std::uint64_t, std::uint64_t>, Submitted, KeyHash> submitted;
+};
+
+/* Import a CSV file, reading it a chunk at a time. */
+[[maybe_unused]]
+static auto import_trace(const std::string &path, const ImportFormat &format,
+    const ImportOptions &options, ImportStats *stats = nullptr)
+-> std::pair <Description, std::vector <Task>> {
+    static constexpr std::size_t kChunk = 1 << 22;
+
+    std::ifstream file { path, std::ios::binary };
+    if (!file.is_open())
+        panic <SystemException> ("Import: Cannot open " + path);
+
+    TraceImporter importer { format, options };
+    std::vector <char> buffer(kChunk);
+    while (importer.hungry()) {
+        const auto size = file.rdbuf()->sgetn(buffer.data(), buffer.size());
+        if (size <= 0) break;
+        importer.feed({ buffer.data(), std::size_t(size) });
+    }
+
+    auto result = importer.finish();
+    if (stats != nullptr) *stats = importer.stats;
+    return result;
+}
+
+} // namespace oj::detail::runtime
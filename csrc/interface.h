@@ -1,4 +1,5 @@
 #pragma once
+#include <span>
 #include <vector>
 #include <cstdint>
 #include <variant>
@@ -15,6 +16,8 @@ struct Description;
 struct Launch;
 struct Saving;
 struct Cancel;
+struct TaskView;
+struct Release;
 
 using Policy = std::variant<Launch, Saving, Cancel>;
 
@@ -39,4 +42,70 @@ auto generate_tasks(const Description &desc) -> std::vector <Task>;
  */
 auto schedule_tasks(time_t time, std::vector <Task> list, const Description &desc) -> std::vector<Policy>;
 
+/**
+ * @brief Runtime side.
+ * A read-only view of the runtime, which is provided to you.
+ * You may query it within schedule_tasks, instead of keeping track of
+ * the CPUs and tasks by yourself. It reflects the state before the
+ * policies of the current time are applied.
+ */
+struct RuntimeView {
+    /* Count of CPUs held by all the containers. */
+    virtual auto get_cpu_usage() const -> cpu_id_t = 0;
+    /* State of a task that has arrived. */
+    virtual auto get_task(task_id_t task_id) const -> TaskView = 0;
+    /* Upcoming CPU releases of saving containers, ordered by time. */
+    virtual auto get_releases() const -> std::vector <Release> = 0;
+    /* Tasks which have just become provably unable to complete. */
+    virtual auto get_infeasible() const -> std::vector <task_id_t> = 0;
+
+protected:
+    ~RuntimeView() = default;
+};
+
+/**
+ * @brief Runtime side.
+ * @return The view of the runtime, only valid within schedule_tasks.
+ */
+auto runtime_view() -> const RuntimeView &;
+
+/**
+ * @brief Runtime side.
+ * What an event-driven scheduler may do within its callbacks.
+ */
+struct EventContext {
+    virtual auto get_time() const -> time_t = 0;
+    /* Apply the policy at the current time, after all the callbacks. */
+    virtual void submit(Policy policy) = 0;
+    /* Call on_timer at the given time, which must be in the future. */
+    virtual void set_timer(time_t time) = 0;
+
+protected:
+    ~EventContext() = default;
+};
+
+/**
+ * @brief Scheduler side, an event-driven alternative to schedule_tasks.
+ * The runtime calls back only at the times something happens, in the
+ * order of the callbacks below, and never on idle ticks.
+ * on_timer(0) is always called, so that you may set your first timer.
+ * Task IDs are assigned in order of arrival, the same as schedule_tasks.
+ */
+struct EventScheduler {
+    /**
+     * A saving completes, and its CPUs may be launched again from now.
+     * The task itself is free only from the next tick, so set a timer to
+     * launch it again. Saved after its deadline, it is never free again.
+     */
+    virtual void on_save_complete(EventContext &, task_id_t /* task_id */, double /* progress */) {}
+    /* The deadline of an incomplete task has just passed. */
+    virtual void on_deadline_passed(EventContext &, task_id_t /* task_id */) {}
+    /* New tasks arrive. */
+    virtual void on_arrival(EventContext &, std::span <const Task> /* list */) {}
+    /* A timer set before goes off. */
+    virtual void on_timer(EventContext &, time_t /* time */) {}
+
+    virtual ~EventScheduler() = default;
+};
+
 } // namespace oj
\ No newline at end of file
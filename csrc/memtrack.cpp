@@ -0,0 +1,182 @@
+/**
+ * Track the heap and RSS of a run, as the server build would see them.
+ *
+ * Usage: memtrack [-w width] <dataset>...
+ * Counters are reported for every range of width ticks.
+ * A dataset is either a file serialized by client.cpp,
+ * or the index (0 ~ 3) of a preset in testcase_array.
+ *
+ * This file replaces the global operator new / delete and interposes
+ * malloc and friends (glibc only), so it must be linked only once.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "memtrack.h"
+#include "src.hpp"
+#include <new>
+#include <malloc.h>
+#include <cerrno>
+
+#if defined(__GLIBC__)
+
+extern "C" {
+void *__libc_malloc(std::size_t);
+void *__libc_calloc(std::size_t, std::size_t);
+void *__libc_realloc(void *, std::size_t);
+void *__libc_memalign(std::size_t, std::size_t);
+void *__libc_valloc(std::size_t);
+void *__libc_pvalloc(std::size_t);
+void  __libc_free(void *);
+}
+
+namespace {
+
+using oj::detail::runtime::heap_tracker;
+
+auto track_alloc(void *ptr) -> void * {
+    if (ptr != nullptr) heap_tracker.on_alloc(::malloc_usable_size(ptr));
+    return ptr;
+}
+
+void track_free(void *ptr) {
+    if (ptr != nullptr) heap_tracker.on_free(::malloc_usable_size(ptr));
+}
+
+const bool hooked = (heap_tracker.hooked = true);
+
+} // namespace
+
+extern "C" {
+
+void *malloc(std::size_t size) {
+    return track_alloc(__libc_malloc(size));
+}
+
+void *calloc(std::size_t count, std::size_t size) {
+    return track_alloc(__libc_calloc(count, size));
+}
+
+void *realloc(void *ptr, std::size_t size) {
+    // The old block is gone once realloc returns, so size it first.
+    const auto old_size = ptr == nullptr ? 0 : ::malloc_usable_size(ptr);
+    auto *result = __libc_realloc(ptr, size);
+    // On failure, the old block stays as it was.
+    if (result == nullptr && size != 0) return nullptr;
+    if (ptr != nullptr) heap_tracker.on_free(old_size);
+    return track_alloc(result);
+}
+
+void *reallocarray(void *ptr, std::size_t count, std::size_t size) {
+    std::size_t total;
+    if (__builtin_mul_overflow(count, size, &total)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return ::realloc(ptr, total);
+}
+
+void *memalign(std::size_t align, std::size_t size) {
+    return track_alloc(__libc_memalign(align, size));
+}
+
+void *aligned_alloc(std::size_t align, std::size_t size) {
+    return track_alloc(__libc_memalign(align, size));
+}
+
+void *valloc(std::size_t size) {
+    return track_alloc(__libc_valloc(size));
+}
+
+void *pvalloc(std::size_t size) {
+    return track_alloc(__libc_pvalloc(size));
+}
+
+int posix_memalign(void **ptr, std::size_t align, std::size_t size) {
+    *ptr = track_alloc(__libc_memalign(align, size));
+    return *ptr == nullptr ? ENOMEM : 0;
+}
+
+void free(void *ptr) {
+    track_free(ptr);
+    __libc_free(ptr);
+}
+
+} // extern "C"
+
+/* Route operator new / delete through malloc, even with a static libstdc++. */
+void *operator new(std::size_t size) {
+    if (auto *ptr = ::malloc(std::max <std::size_t> (size, 1))) return ptr;
+    throw std::bad_alloc {};
+}
+
+void *operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t align) {
+    const auto alignment = std::max(std::size_t(align), sizeof(void *));
+    if (auto *ptr = ::aligned_alloc(alignment, std::max <std::size_t> (size, 1))) return ptr;
+    throw std::bad_alloc {};
+}
+
+void *operator new[](std::size_t size, std::align_val_t align) {
+    return ::operator new(size, align);
+}
+
+void operator delete(void *ptr) noexcept { ::free(ptr); }
+void operator delete[](void *ptr) noexcept { ::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { ::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { ::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { ::free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { ::free(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { ::free(ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { ::free(ptr); }
+
+#endif // __GLIBC__
+
+namespace oj::detail::runtime {
+
+static void memtrack(const std::string &name, time_t width) {
+    auto [desc, tasks] = load_dataset(name);
+
+    MemoryProbe memory { width };
+    const auto info = schedule_work(desc, std::move(tasks), memory);
+
+    std::cout << "dataset " << name
+              << " complete " << info.complete
+              << " total " << info.total << '\n';
+    memory.report(std::cout);
+    std::cout.flush();
+}
+
+} // namespace oj::detail::runtime
+
+signed main(int argc, char *argv[]) {
+    oj::time_t width = 100000;
+    std::vector <std::string> names;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "-w" && i + 1 < argc) width = std::stoull(argv[++i]);
+        else names.emplace_back(arg);
+    }
+
+    if (names.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [-w width] <dataset>...\n";
+        return 1;
+    }
+
+    try {
+        for (const auto &name : names) {
+            // Each dataset starts with a fresh scheduler and fresh counters.
+            oj::detail::runtime::run_isolated([&]() -> bool {
+                oj::detail::runtime::memtrack(name, width);
+                return true;
+            });
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
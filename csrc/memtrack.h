@@ -0,0 +1,216 @@
+#pragma once
+#include "runtime.h"
+#include <atomic>
+#include <fstream>
+#include <unistd.h>
+
+/**
+ * Heap and RSS tracking of a run. The counters are fed by the allocation
+ * hooks of memtrack.cpp, which replace the global operator new / delete
+ * and interpose malloc; without them, only RSS is reported.
+ *
+ * Allocations made inside schedule_tasks are told apart from those of the
+ * runtime, since the scheduler is what must fit in the memory limit.
+ */
+namespace oj::detail::runtime {
+
+struct HeapCounters {
+    std::uint64_t allocs;
+    std::uint64_t frees;
+    std::uint64_t bytes;    // Allocated in total
+
+    auto operator - (const HeapCounters &other) const -> HeapCounters {
+        return {
+            .allocs = allocs - other.allocs,
+            .frees  = frees - other.frees,
+            .bytes  = bytes - other.bytes,
+        };
+    }
+};
+
+/**
+ * @brief The counters, by owner: 0 for the runtime, 1 for the scheduler,
+ * and the live heap of the whole process. Updated with relaxed atomics,
+ * as allocations may come from any thread.
+ */
+struct HeapTracker {
+    struct Owner {
+        std::atomic <std::uint64_t> allocs;
+        std::atomic <std::uint64_t> frees;
+        std::atomic <std::uint64_t> bytes;
+    };
+
+    void on_alloc(std::size_t size) {
+        auto &owner = owners[in_scheduler.load(std::memory_order_relaxed)];
+        owner.allocs.fetch_add(1, std::memory_order_relaxed);
+        owner.bytes.fetch_add(size, std::memory_order_relaxed);
+        const auto now = live.fetch_add(size, std::memory_order_relaxed) + size;
+        auto last = peak.load(std::memory_order_relaxed);
+        while (now > last && !peak.compare_exchange_weak(last, now, std::memory_order_relaxed)) {}
+    }
+
+    /* A free is counted for whoever runs then, not who allocated. */
+    void on_free(std::size_t size) {
+        auto &owner = owners[in_scheduler.load(std::memory_order_relaxed)];
+        owner.frees.fetch_add(1, std::memory_order_relaxed);
+        live.fetch_sub(size, std::memory_order_relaxed);
+    }
+
+    auto get(bool scheduler) const -> HeapCounters {
+        const auto &owner = owners[scheduler];
+        return {
+            .allocs = owner.allocs.load(std::memory_order_relaxed),
+            .frees  = owner.frees.load(std::memory_order_relaxed),
+            .bytes  = owner.bytes.load(std::memory_order_relaxed),
+        };
+    }
+
+    auto get_live() const -> std::uint64_t {
+        return live.load(std::memory_order_relaxed);
+    }
+
+    /* Peak of the live heap, since the last reset. */
+    auto get_peak() const -> std::uint64_t {
+        return peak.load(std::memory_order_relaxed);
+    }
+
+    void reset_peak() {
+        peak.store(live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    std::array <Owner, 2> owners {};
+    std::atomic <std::uint64_t> live = 0;
+    std::atomic <std::uint64_t> peak = 0;
+    bool hooked = false;                        // Set by the allocation hooks
+    std::atomic <bool> in_scheduler = false;    // Whether schedule_tasks is running
+};
+
+inline constinit HeapTracker heap_tracker {};
+
+/* Resident set size of this process, in bytes. */
+inline auto current_rss() -> std::uint64_t {
+    std::ifstream statm { "/proc/self/statm" };
+    std::uint64_t size = 0, resident = 0;
+    if (!(statm >> size >> resident)) return 0;
+    return resident * ::sysconf(_SC_PAGESIZE);
+}
+
+/* Peak resident set size of this process, in bytes. */
+inline auto read_peak_rss() -> std::uint64_t {
+    std::ifstream status { "/proc/self/status" };
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.starts_with("VmHWM:"))
+            return std::stoull(line.substr(6)) * 1024;
+    }
+    return 0;
+}
+
+/**
+ * @brief Snapshots of the counters every `width` ticks, taken between
+ * ticks, so each range shows its allocations and the live heap after it.
+ */
+struct MemoryProbe : public Probe {
+    struct Range {
+        time_t          first;
+        HeapCounters    scheduler;  // Of the range
+        HeapCounters    runtime;
+        std::uint64_t   live;       // At the end of the range
+        std::uint64_t   peak;       // Within the range
+        std::uint64_t   rss;        // At the end of the range
+    };
+
+    explicit MemoryProbe(time_t width) : width(std::max <time_t> (width, 1)) {}
+
+    void on_start(RuntimeManager &) {
+        heap_tracker.reset_peak();
+        last_scheduler = heap_tracker.get(true);
+        last_runtime = heap_tracker.get(false);
+    }
+
+    void before_schedule(time_t) {
+        heap_tracker.in_scheduler.store(true, std::memory_order_relaxed);
+    }
+
+    void after_schedule(time_t, const std::vector <Policy> &) {
+        heap_tracker.in_scheduler.store(false, std::memory_order_relaxed);
+    }
+
+    void after_work(time_t time) {
+        if ((time + 1) % width == 0) this->snapshot(time + 1 - width);
+    }
+
+    void on_finish(const RuntimeManager &manager) {
+        const auto time = manager.get_time();
+        if (time % width != 0) this->snapshot(time - time % width);
+        peak_rss = read_peak_rss();
+    }
+
+    void report(std::ostream &os) const {
+        constexpr double kMiB = 1 << 20;
+        const auto scheduler = heap_tracker.get(true);
+        const auto runtime = heap_tracker.get(false);
+
+        os << std::fixed << std::setprecision(2);
+        if (heap_tracker.hooked) {
+            auto print = [&](std::string_view name, const HeapCounters &counters) {
+                os << name
+                   << " allocs " << counters.allocs
+                   << " frees " << counters.frees
+                   << " bytes_mib " << counters.bytes / kMiB << '\n';
+            };
+            print("scheduler", scheduler);
+            print("runtime", runtime);
+            os << "peak_live_mib " << peak_live / kMiB << '\n';
+        } else {
+            os << "heap not tracked, build with memtrack.cpp\n";
+        }
+        os << "peak_rss_mib " << peak_rss / kMiB;
+        if (peak_rss > kMemoryLimit) os << " EXCEEDS " << kMemoryLimit / kMiB;
+        os << '\n';
+
+        for (const auto &range : ranges) {
+            os << "ticks [" << range.first << ", " << range.first + width << ")"
+               << " rss_mib " << range.rss / kMiB;
+            if (heap_tracker.hooked) {
+                os << " live_mib " << range.live / kMiB
+                   << " peak_live_mib " << range.peak / kMiB
+                   << " scheduler_allocs " << range.scheduler.allocs
+                   << " scheduler_mib " << range.scheduler.bytes / kMiB
+                   << " runtime_allocs " << range.runtime.allocs
+                   << " runtime_mib " << range.runtime.bytes / kMiB;
+            }
+            os << '\n';
+        }
+    }
+
+    static constexpr std::uint64_t kMemoryLimit = std::uint64_t(512) << 20;
+
+private:
+    void snapshot(time_t first) {
+        const auto scheduler = heap_tracker.get(true);
+        const auto runtime = heap_tracker.get(false);
+        const auto peak = heap_tracker.get_peak();
+        peak_live = std::max(peak_live, peak);
+        ranges.push_back({
+            .first      = first,
+            .scheduler  = scheduler - last_scheduler,
+            .runtime    = runtime - last_runtime,
+            .live       = heap_tracker.get_live(),
+            .peak       = peak,
+            .rss        = current_rss(),
+        });
+        heap_tracker.reset_peak();
+        last_scheduler = scheduler;
+        last_runtime = runtime;
+    }
+
+    time_t              width;
+    HeapCounters        last_scheduler {};
+    HeapCounters        last_runtime {};
+    std::uint64_t       peak_live = 0;
+    std::uint64_t       peak_rss = 0;
+    std::vector <Range> ranges;
+};
+
+} // namespace oj::detail::runtime
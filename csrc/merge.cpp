@@ -0,0 +1,53 @@
+/**
+ * Schedule the task sets of several tenants at once.
+ *
+ * Usage: merge <dataset>...
+ * A dataset is either a file serialized by client.cpp,
+ * or the index (0 ~ 3) of a preset in testcase_array.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "merge.h"
+#include "src.hpp"
+
+namespace oj::detail::runtime {
+
+static void merge(std::span <const std::string> names) {
+    std::vector <Description> descs;
+    std::vector <std::vector <Task>> tenants;
+    for (const auto &name : names) {
+        auto [desc, tasks] = load_dataset(name);
+        descs.push_back(desc);
+        tenants.push_back(std::move(tasks));
+    }
+
+    const auto result = schedule_tenants(descs, std::move(tenants));
+
+    std::cout << std::fixed << std::setprecision(6);
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        std::cout << "tenant " << names[i]
+                  << " complete " << result[i].complete
+                  << " total " << result[i].total
+                  << " slo " << slo_rate(result[i]) << std::endl;
+    }
+    std::cout << "merged complete " << result.back().complete
+              << " total " << result.back().total
+              << " slo " << slo_rate(result.back()) << std::endl;
+}
+
+} // namespace oj::detail::runtime
+
+signed main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <dataset>...\n";
+        return 1;
+    }
+    try {
+        const std::vector <std::string> names(argv + 1, argv + argc);
+        oj::detail::runtime::merge(names);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
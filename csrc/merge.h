@@ -0,0 +1,155 @@
+#pragma once
+#include "runtime.h"
+#include <deque>
+
+/**
+ * Multi-tenant workloads: the task sets of several generators, each
+ * validated on its own, are merged by launch_time into one stream.
+ * Task IDs are remapped in the order of arrival, as usual, and the
+ * service of each tenant is accounted separately.
+ */
+namespace oj::detail::runtime {
+
+struct TenantMerger : public RuntimeListener {
+private:
+    struct Head {
+        time_t      launch_time;
+        std::size_t tenant;
+        auto operator <=> (const Head &) const = default;
+    };
+
+    struct Live {
+        std::size_t tenant;
+        priority_t  priority;
+    };
+
+    /* Pull the next task of a tenant into the heap. */
+    void pull(std::size_t tenant) {
+        auto &head = heads[tenant];
+        head = tenants[tenant]();
+        if (head.has_value())
+            queue.push({ head->launch_time, tenant });
+    }
+
+    /* K-way merge. Ties go to the tenant listed first. */
+    auto next() -> std::optional <Task> {
+        if (queue.empty()) return std::nullopt;
+        const auto tenant = queue.top().tenant;
+        queue.pop();
+
+        const auto task = *heads[tenant];
+        emitted.push_back(tenant);
+        this->pull(tenant);
+        return task;
+    }
+
+public:
+    explicit TenantMerger(std::vector <TaskSource> tenants)
+        : tenants(std::move(tenants)), heads(this->tenants.size()),
+          service(this->tenants.size(), ServiceInfo { .complete = 0, .total = 0 }) {
+        for (std::size_t tenant = 0; tenant < this->tenants.size(); ++tenant)
+            this->pull(tenant);
+    }
+
+    /* The merged stream. The merger must outlive it. */
+    auto source() -> TaskSource {
+        return [this]() { return this->next(); };
+    }
+
+    void on_arrive(task_id_t task_id, const Task &task) override {
+        // The runtime pulls tasks in the order they arrive.
+        const auto tenant = emitted.front();
+        emitted.pop_front();
+        live.emplace(task_id, Live { tenant, task.priority });
+        service[tenant].total += task.priority;
+    }
+
+    void on_complete(task_id_t task_id) override {
+        const auto &task = live.at(task_id);
+        service[task.tenant].complete += task.priority;
+    }
+
+    void on_retire(task_id_t task_id) override {
+        live.erase(task_id);
+    }
+
+    auto get_tenant_count() const -> std::size_t {
+        return tenants.size();
+    }
+
+    auto get_service_info(std::size_t tenant) const -> ServiceInfo {
+        return service[tenant];
+    }
+
+private:
+    std::vector <TaskSource> tenants;
+    std::vector <std::optional <Task>> heads;   // The next task of each tenant
+    std::priority_queue <Head, std::vector <Head>, std::greater <>> queue;
+    std::deque <std::size_t> emitted;           // Tenants of tasks pulled ahead
+    std::unordered_map <task_id_t, Live> live;  // Live tasks -> tenant
+    std::vector <ServiceInfo> service;          // Service of each tenant
+};
+
+/**
+ * @brief The description seen by the scheduler: the ranges cover those
+ * of every tenant, and the counts and sums add up. The cluster is that
+ * of the first tenant.
+ */
+inline auto merge_description(std::span <const Description> descs) -> Description {
+    if (descs.empty())
+        panic <SystemException> ("Merge: No tenant.");
+
+    auto result = descs[0];
+    for (const auto &desc : descs.subspan(1)) {
+        auto merge_range = [](auto &x, const auto &y) {
+            x.min = std::min(x.min, y.min);
+            x.max = std::max(x.max, y.max);
+        };
+        auto add_range = [](auto &x, const auto &y) {
+            x.min += y.min;
+            x.max += y.max;
+        };
+        result.task_count += desc.task_count;
+        merge_range(result.deadline_time, desc.deadline_time);
+        merge_range(result.execution_time_single, desc.execution_time_single);
+        merge_range(result.priority_single, desc.priority_single);
+        add_range(result.execution_time_sum, desc.execution_time_sum);
+        add_range(result.priority_sum, desc.priority_sum);
+    }
+    return result;
+}
+
+/**
+ * @brief Check each tenant against its own description, and schedule
+ * them all on one runtime.
+ * @return Service of each tenant, followed by the total.
+ */
+[[maybe_unused]]
+static auto schedule_tenants(
+    std::span <const Description> descs, std::vector <std::vector <Task>> tenants)
+-> std::vector <ServiceInfo> {
+    if (descs.size() != tenants.size())
+        panic <SystemException> ("Merge: Tenant count mismatch.");
+
+    std::vector <TaskSource> sources;
+    for (std::size_t i = 0; i < tenants.size(); ++i) {
+        std::ranges::sort(tenants[i], {}, &Task::launch_time);
+        check_tasks(tenants[i], descs[i]);
+        sources.push_back(make_source(std::move(tenants[i])));
+    }
+
+    const auto desc = merge_description(descs);
+    TenantMerger merger { std::move(sources) };
+    RuntimeManager manager { merger.source(), { .cpu_count = desc.cpu_count } };
+    manager.add_listener(merger);
+
+    const auto total = schedule_loop(desc, manager);
+
+    std::vector <ServiceInfo> result;
+    for (std::size_t i = 0; i < merger.get_tenant_count(); ++i)
+        result.push_back(merger.get_service_info(i));
+    result.push_back(total);
+    return result;
+}
+
+} // namespace oj::detail::runtime
@@ -0,0 +1,155 @@
+#pragma once
+#include "runtime.h"
+#include <atomic>
+#include <thread>
+#include <exception>
+
+/**
+ * Pipelined scheduling: schedule_tasks runs on its own thread, ahead of
+ * the simulation, for every tick known to have no arrival. Its plans
+ * reach the runtime through a lock-free single-producer single-consumer
+ * queue. At a tick with arrivals, the runtime calls schedule_tasks
+ * itself, once the scheduler thread has drained.
+ *
+ * The calls are exactly those of schedule_work, in the same order, only
+ * on two threads. Hence the scheduler must not use thread-local state,
+ * and it gets no runtime_view on the scheduler thread.
+ */
+namespace oj::detail::runtime {
+
+/* A bounded lock-free queue, with one thread pushing and one popping. */
+template <typename _Tp, std::size_t _Capacity = 1024>
+struct SpscQueue {
+    static_assert(std::has_single_bit(_Capacity));
+
+    auto try_push(_Tp &value) -> bool {
+        const auto tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - head.load(std::memory_order_acquire) == _Capacity)
+            return false;
+        buffer[tail % _Capacity] = std::move(value);
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    auto try_pop() -> std::optional <_Tp> {
+        const auto head = this->head.load(std::memory_order_relaxed);
+        if (head == tail.load(std::memory_order_acquire))
+            return std::nullopt;
+        auto value = std::move(buffer[head % _Capacity]);
+        this->head.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+private:
+    alignas(64) std::atomic <std::size_t> head = 0;
+    alignas(64) std::atomic <std::size_t> tail = 0;
+    std::array <_Tp, _Capacity> buffer;
+};
+
+struct Pipeline {
+private:
+    /* Ticks [from, to] to plan ahead, which have no arrival. */
+    struct Window {
+        time_t from;
+        time_t to;
+    };
+
+    struct Plan {
+        time_t time;
+        std::vector <Policy> policies;
+    };
+
+    void produce(std::stop_token token) {
+        try {
+            while (!token.stop_requested()) {
+                auto window = windows.try_pop();
+                if (!window.has_value()) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (auto time = window->from; time <= window->to; ++time) {
+                    Plan plan { time, schedule_tasks(time, {}, desc) };
+                    while (!plans.try_push(plan)) {
+                        if (token.stop_requested()) return;
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        } catch (...) {
+            error = std::current_exception();
+            failed.store(true, std::memory_order_release);
+        }
+    }
+
+    /* Plan ahead until the next arrival. */
+    void plan_after(time_t time) {
+        const auto limit = desc.deadline_time.max + 1;
+        const auto next = std::min(manager.get_next_arrival().value_or(limit), limit);
+        if (time + 1 >= next) return;
+        Window window { time + 1, next - 1 };
+        while (!windows.try_push(window))
+            std::this_thread::yield();
+        pending += next - 1 - time;
+    }
+
+    auto wait_plan(time_t time) -> std::vector <Policy> {
+        while (true) {
+            if (auto plan = plans.try_pop()) {
+                if (plan->time != time)
+                    panic <SystemException> ("Pipeline: Plan is out of order.");
+                pending -= 1;
+                return std::move(plan->policies);
+            }
+            if (failed.load(std::memory_order_acquire))
+                std::rethrow_exception(error);
+            std::this_thread::yield();
+        }
+    }
+
+public:
+    Pipeline(const Description &desc, RuntimeManager &manager)
+        : desc(desc), manager(manager), pending(0) {}
+
+    auto run() -> ServiceInfo {
+        const ViewGuard guard { manager };
+        std::jthread worker { [this](std::stop_token token) { this->produce(token); } };
+
+        this->plan_after(-1);
+        for (std::size_t i = 0; i <= desc.deadline_time.max; ++i) {
+            auto new_tasks = manager.synchronize();
+            if (i != manager.get_time())
+                panic <SystemException> ("Time is not synchronized");
+
+            if (new_tasks.empty() && pending != 0) {
+                manager.work(this->wait_plan(i));
+            } else {
+                // Every plan has been taken, so the worker is idle.
+                manager.work(schedule_tasks(i, std::move(new_tasks), desc));
+                this->plan_after(i);
+            }
+        }
+
+        manager.synchronize();
+
+        return manager.get_service_info();
+    }
+
+private:
+    const Description &desc;
+    RuntimeManager &manager;
+
+    std::size_t pending;                // Plans not yet taken
+    SpscQueue <Window, 64> windows;     // Runtime -> scheduler
+    SpscQueue <Plan> plans;             // Scheduler -> runtime
+    std::atomic <bool> failed = false;  // Whether the scheduler threw
+    std::exception_ptr error;
+};
+
+[[maybe_unused]]
+static auto schedule_pipelined(const Description &desc, std::vector <Task> tasks)
+-> ServiceInfo {
+    RuntimeManager manager { std::move(tasks), { .cpu_count = desc.cpu_count } };
+    return Pipeline { desc, manager }.run();
+}
+
+} // namespace oj::detail::runtime
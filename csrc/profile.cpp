@@ -0,0 +1,86 @@
+/**
+ * Profile the scheduler and the simulator, tick by tick.
+ *
+ * Usage: profile [-n top] [-c width] [-p fd [-t ticks] [-m ms]] <dataset>...
+ * With -c, hardware counters of schedule_tasks are also reported,
+ * summed over buckets of width ticks.
+ * With -p, progress snapshots are written to the fd while running,
+ * every so many ticks and every so many ms of wall time (default 1000).
+ * A dataset is either a file serialized by client.cpp,
+ * or the index (0 ~ 3) of a preset in testcase_array.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "profile.h"
+#include "counters.h"
+#include "progress.h"
+#include "src.hpp"
+
+namespace oj::detail::runtime {
+
+struct Options {
+    std::size_t     top_count = 10;
+    time_t          width = 0;
+    int             progress_fd = -1;
+    time_t          progress_ticks = 0;
+    std::uint64_t   progress_ms = 1000;
+};
+
+static void profile(const std::string &name, const Options &options) {
+    auto [desc, tasks] = load_dataset(name);
+
+    LatencyProbe latency { options.top_count };
+    ProgressProbe progress { options.progress_fd, options.progress_ticks, options.progress_ms };
+    auto print = [&](const ServiceInfo &info) {
+        std::cout << "dataset " << name
+                  << " complete " << info.complete
+                  << " total " << info.total << '\n';
+        latency.report(std::cout);
+    };
+
+    // The latency probe goes first, to be innermost around each step.
+    if (options.width == 0) {
+        print(schedule_work(desc, std::move(tasks), latency, progress));
+    } else {
+        CounterProbe counter { options.width };
+        print(schedule_work(desc, std::move(tasks), latency, progress, counter));
+        counter.report(std::cout);
+    }
+    std::cout.flush();
+}
+
+} // namespace oj::detail::runtime
+
+signed main(int argc, char *argv[]) {
+    oj::detail::runtime::Options options;
+    std::vector <std::string> names;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) options.top_count = std::stoul(argv[++i]);
+        else if (arg == "-c" && i + 1 < argc) options.width = std::stoull(argv[++i]);
+        else if (arg == "-p" && i + 1 < argc) options.progress_fd = std::stoi(argv[++i]);
+        else if (arg == "-t" && i + 1 < argc) options.progress_ticks = std::stoull(argv[++i]);
+        else if (arg == "-m" && i + 1 < argc) options.progress_ms = std::stoull(argv[++i]);
+        else names.emplace_back(arg);
+    }
+
+    if (names.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [-n top] [-c width] [-p fd [-t ticks] [-m ms]] <dataset>...\n";
+        return 1;
+    }
+
+    try {
+        for (const auto &name : names) {
+            // Each dataset starts with a fresh scheduler.
+            oj::detail::runtime::run_isolated([&]() -> bool {
+                oj::detail::runtime::profile(name, options);
+                return true;
+            });
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,199 @@
+#pragma once
+#include "runtime.h"
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* Low-overhead timing of each step of schedule_loop. */
+namespace oj::detail::runtime {
+
+/* A cheap timestamp, in TSC cycles where available, otherwise in ns. */
+inline auto read_tsc() -> std::uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    using namespace std::chrono;
+    return duration_cast <nanoseconds> (steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * @brief Converts timestamps to nanoseconds, by measuring the rate of
+ * read_tsc against the steady clock between construction and finish().
+ */
+struct TscClock {
+    using clock = std::chrono::steady_clock;
+
+    TscClock() : tsc(read_tsc()), wall(clock::now()), rate(1) {}
+
+    void finish() {
+        const auto cycles = read_tsc() - tsc;
+        const auto nanos = std::chrono::duration <double, std::nano> (clock::now() - wall);
+        if (cycles != 0 && nanos.count() > 0)
+            rate = nanos.count() / cycles;
+    }
+
+    auto to_nanos(std::uint64_t cycles) const -> double {
+        return cycles * rate;
+    }
+
+private:
+    std::uint64_t       tsc;
+    clock::time_point   wall;
+    double              rate;   // Nanoseconds per cycle
+};
+
+/**
+ * @brief A log-linear histogram in the manner of HDR histograms:
+ * every power of two is split into 2^_Precision buckets, so a value
+ * is recorded within a relative error of 2^-_Precision.
+ */
+template <std::size_t _Precision = 5>
+struct Histogram {
+    static constexpr std::size_t kSub = std::size_t(1) << _Precision;
+    static constexpr std::size_t kBuckets = (64 - _Precision + 1) * kSub;
+
+    static auto index_of(std::uint64_t value) -> std::size_t {
+        if (value < kSub) return value;
+        const auto shift = std::bit_width(value) - 1 - _Precision;
+        return (shift + 1) * kSub + (value >> shift) - kSub;
+    }
+
+    /* The upper bound of values in the bucket. */
+    static auto value_of(std::size_t index) -> std::uint64_t {
+        if (index < kSub) return index;
+        const auto shift = index / kSub - 1;
+        const auto base = (index % kSub + kSub) << shift;
+        return base + ((std::uint64_t(1) << shift) - 1);
+    }
+
+    void record(std::uint64_t value) {
+        buckets[index_of(value)] += 1;
+        count += 1;
+        total += value;
+        max = std::max(max, value);
+    }
+
+    /* The value at the given percentile, within 0 and 100. */
+    auto percentile(double p) const -> std::uint64_t {
+        if (count == 0) return 0;
+        const auto rank = std::max <std::uint64_t> (1, std::ceil(count * p / 100));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            seen += buckets[i];
+            if (seen >= rank) return std::min(value_of(i), max);
+        }
+        return max;
+    }
+
+    std::array <std::uint64_t, kBuckets> buckets {};
+    std::uint64_t count = 0;
+    std::uint64_t total = 0;
+    std::uint64_t max   = 0;
+};
+
+/**
+ * @brief Latency of schedule_tasks, RuntimeManager::synchronize and
+ * RuntimeManager::work at every tick, with the slowest scheduler ticks.
+ * Given first to schedule_work, it times only the steps themselves, and
+ * none of the hooks of the other probes.
+ */
+struct LatencyProbe : public Probe {
+    struct Slow {
+        std::uint64_t   cycles;
+        time_t          time;
+        std::size_t     arrivals;
+        auto operator <=> (const Slow &) const = default;
+    };
+
+    explicit LatencyProbe(std::size_t top_count = 10) : top_count(top_count) {}
+
+    void before_synchronize(time_t) {
+        stamp = read_tsc();
+    }
+
+    void after_synchronize(time_t, const std::vector <Task> &list) {
+        synchronize.record(read_tsc() - stamp);
+        arrivals = list.size();
+    }
+
+    void before_schedule(time_t) {
+        stamp = read_tsc();
+    }
+
+    void after_schedule(time_t time, const std::vector <Policy> &) {
+        const auto cycles = read_tsc() - stamp;
+        schedule.record(cycles);
+
+        if (slowest.size() < top_count) {
+            slowest.push({ cycles, time, arrivals });
+        } else if (top_count != 0 && slowest.top().cycles < cycles) {
+            slowest.pop();
+            slowest.push({ cycles, time, arrivals });
+        }
+    }
+
+    void before_work(time_t) {
+        stamp = read_tsc();
+    }
+
+    void after_work(time_t) {
+        work.record(read_tsc() - stamp);
+    }
+
+    void on_finish(const RuntimeManager &) {
+        clock.finish();
+    }
+
+    /* Cycles to nanoseconds, once finished. */
+    auto to_nanos(std::uint64_t cycles) const -> double {
+        return clock.to_nanos(cycles);
+    }
+
+    void report(std::ostream &os) const {
+        auto print = [&](std::string_view name, const Histogram <> &histogram) {
+            os << std::setw(12) << std::left << name << std::right
+               << " count " << histogram.count
+               << " total_ms " << clock.to_nanos(histogram.total) / 1e6;
+            for (const auto p : { 50.0, 90.0, 99.0, 99.9 })
+                os << " p" << p << "_ns " << clock.to_nanos(histogram.percentile(p));
+            os << " max_ns " << clock.to_nanos(histogram.max) << '\n';
+        };
+
+        os << std::fixed << std::setprecision(1);
+        print("schedule", schedule);
+        print("synchronize", synchronize);
+        print("work", work);
+
+        const auto simulator = clock.to_nanos(synchronize.total + work.total);
+        const auto scheduler = clock.to_nanos(schedule.total);
+        const auto sum = std::max(simulator + scheduler, 1.0);
+        os << "split simulator_ms " << simulator / 1e6
+           << " (" << 100 * simulator / sum << "%)"
+           << " scheduler_ms " << scheduler / 1e6
+           << " (" << 100 * scheduler / sum << "%)\n";
+
+        auto top = slowest;
+        std::vector <Slow> list;
+        while (!top.empty()) list.push_back(top.top()), top.pop();
+        for (const auto &slow : list | std::views::reverse) {
+            os << "slowest tick " << slow.time
+               << " ns " << clock.to_nanos(slow.cycles)
+               << " arrivals " << slow.arrivals << '\n';
+        }
+    }
+
+    Histogram <> schedule;
+    Histogram <> synchronize;
+    Histogram <> work;
+
+private:
+    TscClock clock;
+    std::uint64_t stamp = 0;
+    std::size_t arrivals = 0;
+    std::size_t top_count;
+    std::priority_queue <Slow, std::vector <Slow>, std::greater <>> slowest;
+};
+
+} // namespace oj::detail::runtime
@@ -0,0 +1,91 @@
+#pragma once
+#include "runtime.h"
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+
+/**
+ * Progress snapshots of a long run, written to a file descriptor as one
+ * line each, e.g. to a pipe or to stderr with fd 2.
+ */
+namespace oj::detail::runtime {
+
+struct ProgressProbe : public Probe, public RuntimeListener {
+private:
+    using clock = std::chrono::steady_clock;
+
+    /* The wall clock is only read every so many ticks. */
+    static constexpr time_t kClockStride = 1024;
+
+    void snapshot(time_t time) {
+        const auto now = clock::now();
+        const auto seconds = std::chrono::duration <double> (now - last_wall).count();
+        const auto speed = seconds > 0 ? (time - last_tick) / seconds : 0.0;
+        const auto info = manager->get_service_info();
+        const auto rate = info.total == 0 ? 1.0 : double(info.complete) / info.total;
+
+        char line[256];
+        const auto length = std::snprintf(line, sizeof(line),
+            "tick %llu ticks_per_sec %.0f cpu_usage %llu live %zu completed %zu"
+            " complete %llu total %llu slo %.6f\n",
+            (unsigned long long)time, speed, (unsigned long long)manager->get_cpu_usage(),
+            manager->get_live_tasks(), completed,
+            (unsigned long long)info.complete, (unsigned long long)info.total, rate);
+        const auto total = std::min <std::size_t> (std::max(length, 0), sizeof(line) - 1);
+        for (std::size_t done = 0; done < total;) {
+            const auto size = ::write(fd, line + done, total - done);
+            if (size <= 0) break;
+            done += size;
+        }
+
+        last_tick = time;
+        last_wall = now;
+    }
+
+public:
+    /**
+     * @param fd Where to write, or -1 to disable the probe.
+     * @param every_ticks Snapshot every so many ticks, 0 to disable.
+     * @param every_ms Snapshot every so many milliseconds, 0 to disable.
+     */
+    ProgressProbe(int fd, time_t every_ticks, std::uint64_t every_ms)
+        : fd(fd), every_ticks(every_ticks), every_wall(std::chrono::milliseconds(every_ms)) {}
+
+    void on_start(RuntimeManager &manager) {
+        if (fd < 0) return;
+        this->manager = &manager;
+        manager.add_listener(*this);
+        last_wall = clock::now();
+    }
+
+    void on_complete(task_id_t) override {
+        completed += 1;
+    }
+
+    void after_work(time_t time) {
+        if (fd < 0) return;
+        const auto next = time + 1;
+        if (every_ticks != 0 && next % every_ticks == 0) {
+            this->snapshot(next);
+        } else if (every_wall.count() != 0 && next % kClockStride == 0
+        && clock::now() - last_wall >= every_wall) {
+            this->snapshot(next);
+        }
+    }
+
+    void on_finish(const RuntimeManager &manager) {
+        if (fd < 0) return;
+        this->snapshot(manager.get_time());
+    }
+
+private:
+    int                         fd;
+    time_t                      every_ticks;
+    clock::duration             every_wall;
+    const RuntimeManager       *manager = nullptr;
+    std::size_t                 completed = 0;  // Tasks, not priorities
+    time_t                      last_tick = 0;
+    clock::time_point           last_wall;
+};
+
+} // namespace oj::detail::runtime
@@ -0,0 +1,64 @@
+/**
+ * Record the policies of a run, or score a recorded run again.
+ *
+ * Usage: replay record <dataset> <trace>
+ *        replay verify <dataset> <trace>
+ * verify replays the trace without the scheduler, and fails unless the
+ * service info is the same as recorded.
+ * A dataset is either a file serialized by client.cpp,
+ * or the index (0 ~ 3) of a preset in testcase_array.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "replay.h"
+#include "src.hpp"
+#include <chrono>
+#include <fstream>
+
+namespace oj::detail::runtime {
+
+static auto record(const std::string &name, const std::string &path) -> ServiceInfo {
+    auto [desc, tasks] = load_dataset(name);
+    std::ofstream file { path, std::ios::binary };
+    if (!file.is_open())
+        panic <SystemException> ("Trace: Cannot write " + path);
+    PolicyRecorder recorder { file };
+    return schedule_work(desc, std::move(tasks), recorder);
+}
+
+static auto verify(const std::string &name, const std::string &path) -> ServiceInfo {
+    auto [desc, tasks] = load_dataset(name);
+    std::ifstream file { path, std::ios::binary };
+    if (!file.is_open())
+        panic <SystemException> ("Trace: Cannot read " + path);
+    PolicyReader reader { file };
+    RuntimeManager manager { std::move(tasks), { .cpu_count = desc.cpu_count } };
+    return verify_trace(manager, reader);
+}
+
+} // namespace oj::detail::runtime
+
+signed main(int argc, char *argv[]) {
+    using namespace oj::detail::runtime;
+    using clock = std::chrono::steady_clock;
+
+    const std::string_view command = argc == 4 ? argv[1] : "";
+    if (command != "record" && command != "verify") {
+        std::cerr << "Usage: " << argv[0] << " record|verify <dataset> <trace>\n";
+        return 1;
+    }
+
+    try {
+        const auto start = clock::now();
+        const auto info = command == "record" ? record(argv[2], argv[3]) : verify(argv[2], argv[3]);
+        const auto seconds = std::chrono::duration <double> (clock::now() - start).count();
+        std::cout << command
+                  << " complete " << info.complete
+                  << " total " << info.total
+                  << " seconds " << seconds << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
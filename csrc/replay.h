@@ -0,0 +1,318 @@
+#pragma once
+#include "runtime.h"
+#include <limits>
+#include <optional>
+#include <utility>
+
+/**
+ * Policy traces: the non-empty policy list of each tick, recorded in a
+ * compact binary form, so that a run may be scored again without the
+ * scheduler, or replayed up to a tick for another one to go on. A trace
+ * is laid out as below, all integers in LEB128.
+ *
+ *   magic, cpu_count
+ *   { tick delta, count, { task_id << 2 | kind, [cpu_cnt if Launch] } }...
+ *   end delta, 0, arrival hash, complete, total
+ *
+ * The arrival hash is FNV-1a over the tasks in order of arrival, to tell
+ * a trace replayed on the wrong task set.
+ */
+namespace oj::detail::runtime {
+
+struct PolicyTraceFormat {
+    // 'O' 'J' 'P' 'T', version 1
+    static constexpr std::uint64_t kMagic = 0x54504A4F'00000001;
+
+    enum Kind : std::uint64_t { kLaunch = 0, kSaving = 1, kCancel = 2 };
+
+    /* FNV-1a, fed the tasks as they arrive. */
+    struct Hash {
+        void feed(std::span <const Task> tasks) {
+            const auto bytes = std::as_bytes(tasks);
+            for (const auto byte : bytes) {
+                value ^= std::uint64_t(byte);
+                value *= 0x100000001B3;
+            }
+        }
+
+        std::uint64_t value = 0xCBF29CE484222325;
+    };
+};
+
+/* Records the policies of each tick to the stream, e.g. an std::ofstream. */
+struct PolicyRecorder : public Probe {
+private:
+    static constexpr std::size_t kFlush = 1 << 16;
+
+    void put(std::uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back(char(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(char(value));
+    }
+
+    void flush() {
+        os.write(buffer.data(), buffer.size());
+        if (!os.good())
+            panic <SystemException> ("Trace: Write failed.");
+        buffer.clear();
+    }
+
+public:
+    explicit PolicyRecorder(std::ostream &os) : os(os) {}
+
+    void on_start(RuntimeManager &manager) {
+        this->put(PolicyTraceFormat::kMagic);
+        this->put(manager.get_cluster().cpu_count);
+    }
+
+    void after_synchronize(time_t, const std::vector <Task> &list) {
+        hash.feed(list);
+    }
+
+    void after_schedule(time_t time, const std::vector <Policy> &policies) {
+        if (policies.empty()) return;
+        this->put(time - last);
+        this->put(policies.size());
+        for (const auto &policy : policies) {
+            if (const auto *launch = std::get_if <Launch> (&policy)) {
+                this->put(std::uint64_t(launch->task_id) << 2 | PolicyTraceFormat::kLaunch);
+                this->put(launch->cpu_cnt);
+            } else if (const auto *saving = std::get_if <Saving> (&policy)) {
+                this->put(std::uint64_t(saving->task_id) << 2 | PolicyTraceFormat::kSaving);
+            } else {
+                this->put(std::uint64_t(get <Cancel> (policy).task_id) << 2 | PolicyTraceFormat::kCancel);
+            }
+        }
+        last = time;
+        if (buffer.size() >= kFlush) this->flush();
+    }
+
+    void on_finish(const RuntimeManager &manager) {
+        const auto info = manager.get_service_info();
+        this->put(manager.get_time() - last);
+        this->put(0);
+        this->put(hash.value);
+        this->put(info.complete);
+        this->put(info.total);
+        this->flush();
+        os.flush();
+    }
+
+private:
+    std::ostream               &os;
+    std::string                 buffer;
+    time_t                      last = 0;
+    PolicyTraceFormat::Hash     hash;
+};
+
+/* Reads a policy trace, one tick at a time. */
+struct PolicyReader {
+private:
+    auto get() -> std::uint64_t {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const auto byte = buf.sbumpc();
+            if (byte == std::char_traits <char>::eof())
+                panic <SystemException> ("Trace: File incomplete.");
+            value |= std::uint64_t(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+        panic <SystemException> ("Trace: Malformed integer.");
+    }
+
+public:
+    struct Footer {
+        time_t          end_time;   // Of the last synchronize
+        std::uint64_t   hash;
+        ServiceInfo     info;
+    };
+
+    explicit PolicyReader(std::istream &is) : buf(*is.rdbuf()) {
+        if (this->get() != PolicyTraceFormat::kMagic)
+            panic <SystemException> ("Trace: Not a policy trace.");
+        cpu_count = cpu_id_t(this->get());
+    }
+
+    /* The next tick with policies, or none at the end of the trace. */
+    auto next() -> std::optional <std::pair <time_t, std::vector <Policy>>> {
+        if (footer.has_value()) return std::nullopt;
+
+        time += this->get();
+        const auto count = this->get();
+        if (count == 0) {
+            const auto hash = this->get();
+            const auto complete = this->get();
+            const auto total = this->get();
+            footer = Footer {
+                .end_time   = time,
+                .hash       = hash,
+                .info       = { .complete = complete, .total = total },
+            };
+            return std::nullopt;
+        }
+
+        std::vector <Policy> policies;
+        policies.reserve(count);
+        for (std::uint64_t i = 0; i < count; ++i) {
+            const auto word = this->get();
+            const auto task_id = task_id_t(word >> 2);
+            switch (word & 3) {
+                case PolicyTraceFormat::kLaunch:
+                    policies.push_back(Launch { .cpu_cnt = cpu_id_t(this->get()), .task_id = task_id });
+                    break;
+                case PolicyTraceFormat::kSaving:
+                    policies.push_back(Saving { .task_id = task_id });
+                    break;
+                case PolicyTraceFormat::kCancel:
+                    policies.push_back(Cancel { .task_id = task_id });
+                    break;
+                default:
+                    panic <SystemException> ("Trace: Unknown policy.");
+            }
+        }
+        return std::pair { time, std::move(policies) };
+    }
+
+    auto get_footer() const -> const Footer & {
+        if (!footer.has_value())
+            panic <SystemException> ("Trace: Not read to the end.");
+        return *footer;
+    }
+
+    cpu_id_t    cpu_count;
+
+private:
+    std::streambuf         &buf;
+    time_t                  time = 0;
+    std::optional <Footer>  footer;
+};
+
+/**
+ * @brief Same as synchronize until the time, stopping only at arrivals,
+ * so idle ticks cost nothing.
+ * @return All the tasks arrived on the way.
+ */
+[[maybe_unused]]
+static auto advance_to(RuntimeManager &manager, time_t time) -> std::vector <Task> {
+    // The clock starts from -1, before the first tick.
+    if (time < manager.get_time() + 1)
+        panic <SystemException> ("Replay: Time should only go forward.");
+
+    std::vector <Task> arrived;
+    while (true) {
+        const auto arrival = manager.get_next_arrival();
+        const auto stop = arrival.has_value() ? std::min(*arrival, time) : time;
+        auto list = manager.skip_to(stop);
+        arrived.insert(arrived.end(), list.begin(), list.end());
+        if (stop == time) return arrived;
+    }
+}
+
+/**
+ * @brief Replays a trace on the tasks, with no scheduler. It may pause
+ * before any tick, e.g. for another scheduler to go on from there.
+ */
+struct TraceReplayer {
+private:
+    void advance(time_t time) {
+        const auto list = advance_to(manager, time);
+        hash.feed(list);
+        if (keep_arrived) arrived.insert(arrived.end(), list.begin(), list.end());
+    }
+
+    /* Apply the policies of the records before the time. */
+    void apply_before(time_t time) {
+        while (true) {
+            if (!pending.has_value()) {
+                pending = reader.next();
+                if (!pending.has_value()) return;
+            }
+            auto &[tick, policies] = *pending;
+            if (tick >= time) return;
+            this->advance(tick);
+            manager.work(std::move(policies));
+            pending.reset();
+        }
+    }
+
+public:
+    /* @param keep_arrived Whether to keep the arrived tasks, for get_arrived. */
+    TraceReplayer(RuntimeManager &manager, PolicyReader &reader, bool keep_arrived = false)
+        : manager(manager), reader(reader), keep_arrived(keep_arrived) {
+        if (reader.cpu_count != manager.get_cluster().cpu_count)
+            panic <SystemException> ("Replay: CPU count differs from the trace.");
+    }
+
+    /**
+     * @brief Replay the ticks before the time, so that the manager is
+     * left right before synchronizing to it.
+     */
+    void replay_until(time_t time) {
+        this->apply_before(time);
+        if (time != 0 && manager.get_time() + 1 < time)
+            this->advance(time - 1);
+    }
+
+    /* Replay to the end, and check that it ends the same as recorded. */
+    auto finish() -> ServiceInfo {
+        this->apply_before(std::numeric_limits <time_t>::max());
+
+        const auto &footer = reader.get_footer();
+        this->advance(footer.end_time);
+        if (hash.value != footer.hash)
+            panic <SystemException> ("Replay: Tasks differ from the trace.");
+
+        const auto info = manager.get_service_info();
+        if (info.complete != footer.info.complete || info.total != footer.info.total)
+            panic <SystemException> ("Replay: Service differs from the trace.");
+        return info;
+    }
+
+    /**
+     * @brief Save every running container, and wait for all the CPUs to
+     * be released, so that another scheduler may take over with all the
+     * tasks free. It needs the arrived tasks kept, and the trace may not
+     * be replayed any further.
+     */
+    void drain() {
+        if (manager.get_cpu_usage() == 0) return;
+
+        this->advance(manager.get_time() + 1);
+        std::vector <Policy> savings;
+        for (task_id_t i = 0; i < arrived.size(); ++i)
+            if (manager.get_task(i).state == WorkState::Launch)
+                savings.push_back(Saving { .task_id = i });
+        manager.work(std::move(savings));
+
+        // A saving finishing at a tick leaves the task free from the next.
+        time_t last = 0;
+        for (const auto &release : manager.get_releases())
+            last = std::max(last, release.time);
+        if (last > manager.get_time()) this->advance(last);
+    }
+
+    /* The tasks arrived so far, in order, if kept. */
+    auto get_arrived() const -> const std::vector <Task> & {
+        return arrived;
+    }
+
+private:
+    using Record = std::pair <time_t, std::vector <Policy>>;
+
+    RuntimeManager             &manager;
+    PolicyReader               &reader;
+    bool                        keep_arrived;
+    std::vector <Task>          arrived;
+    std::optional <Record>      pending;    // Read, but not yet due
+    PolicyTraceFormat::Hash     hash;
+};
+
+/* Replay a whole trace, and check that it ends the same as recorded. */
+[[maybe_unused]]
+static auto verify_trace(RuntimeManager &manager, PolicyReader &reader) -> ServiceInfo {
+    return TraceReplayer { manager, reader }.finish();
+}
+
+} // namespace oj::detail::runtime
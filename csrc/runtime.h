@@ -14,7 +14,14 @@
 #include <optional>
 #include <algorithm>
 #include <stdexcept>
+#include <queue>
+#include <memory>
+#include <functional>
 #include <filesystem>
+#include <unordered_map>
+#include <tuple>
+#include <utility>
+#include <set>
 #include <unordered_set>
 
 namespace oj::detail::runtime {
@@ -42,7 +49,112 @@ struct ServiceInfo {
     priority_t total;
 };
 
-struct RuntimeManager : public PublicInformation {
+/**
+ * @brief A lazy source of tasks, which yields tasks in launch_time order.
+ * It returns std::nullopt once all the tasks have been pulled.
+ */
+using TaskSource = std::function <std::optional <Task> ()>;
+
+/* A source backed by a list of tasks in memory. */
+inline auto make_source(std::vector <Task> list) -> TaskSource {
+    auto tasks = std::make_shared <std::vector <Task>> (std::move(list));
+    return [tasks, which = std::size_t(0)]() mutable -> std::optional <Task> {
+        if (which == tasks->size()) return std::nullopt;
+        return (*tasks)[which++];
+    };
+}
+
+/**
+ * @brief A source which reads `count` serialized tasks from the stream,
+ * a chunk at a time. The stream must outlive the source.
+ */
+inline auto make_source(std::istream &is, std::size_t count) -> TaskSource {
+    static constexpr std::size_t kChunk = 4096;
+    struct State {
+        std::istream &is;
+        std::size_t remain;
+        std::size_t which;
+        std::vector <Task> chunk;
+    };
+    auto state = std::make_shared <State> (State {
+        .is     = is,
+        .remain = count,
+        .which  = 0,
+        .chunk  = {},
+    });
+    return [state]() -> std::optional <Task> {
+        auto &[is, remain, which, chunk] = *state;
+        if (which == chunk.size()) {
+            if (remain == 0) return std::nullopt;
+            chunk.resize(std::min(remain, kChunk));
+            const auto size = chunk.size() * sizeof(Task);
+            is.read(std::bit_cast <char *> (chunk.data()), size);
+            if (!is.good())
+                panic <SystemException> ("System Error: File incomplete.");
+            remain -= chunk.size();
+            which = 0;
+        }
+        return chunk[which++];
+    };
+}
+
+/**
+ * @brief Parameters of the simulated cluster.
+ * By default, they are those of the OJ, see PublicInformation.
+ */
+struct Cluster {
+    cpu_id_t    cpu_count   = PublicInformation::kCPUCount;
+    time_t      start_up    = PublicInformation::kStartUp;
+    time_t      saving      = PublicInformation::kSaving;
+};
+
+/**
+ * @brief Table of effective core count k^kAccel, for 0 <= k <= cpu_count.
+ * It saves a std::pow per saving, and a cluster of 10^5 CPUs takes < 1 MiB.
+ */
+struct EffectiveCore : public PublicInformation {
+    explicit EffectiveCore(cpu_id_t cpu_count) : table(cpu_count + 1) {
+        for (cpu_id_t k = 0; k <= cpu_count; ++k)
+            table[k] = std::pow(k, kAccel);
+    }
+
+    auto operator[](cpu_id_t cpu_cnt) const -> double {
+        return table[cpu_cnt];
+    }
+
+    auto max() const -> double {
+        return table.back();
+    }
+
+private:
+    std::vector <double> table;
+};
+
+/**
+ * @brief Observer of the tasks within RuntimeManager.
+ * Task IDs are those seen by the scheduler. All hooks do nothing by default.
+ */
+struct RuntimeListener {
+    /* A task arrives. */
+    virtual void on_arrive(task_id_t /* task_id */, const Task & /* task */) {}
+    /* A task completes before its deadline. */
+    virtual void on_complete(task_id_t /* task_id */) {}
+    /* A container is launched for the task. */
+    virtual void on_launch(task_id_t /* task_id */, cpu_id_t /* cpu_cnt */, time_t /* time */) {}
+    /* The container of the task starts saving. */
+    virtual void on_saving(task_id_t /* task_id */, time_t /* time */) {}
+    /* The saving finishes and the container is released. */
+    virtual void on_saved(task_id_t /* task_id */, time_t /* time */) {}
+    /* The container of the task is cancelled, while launched or saving. */
+    virtual void on_cancel(task_id_t /* task_id */, time_t /* time */) {}
+    /* A task is settled and forgotten, exactly once per task. */
+    virtual void on_retire(task_id_t /* task_id */) {}
+
+protected:
+    ~RuntimeListener() = default;
+};
+
+struct RuntimeManager : public PublicInformation, public RuntimeView {
 private:
     struct TaskFree {
         /* Nothing. */
@@ -61,39 +173,116 @@ private:
         using WorkLoad = std::variant <TaskFree, TaskLaunch, TaskSaving>;
         WorkLoad workload;
         double time_passed; // Total time passed.
-        const time_t deadline;
+        task_id_t   task_id;
+        time_t      deadline;
+        time_t      execution_time;
+        priority_t  priority;
+        bool        expired;    // Deadline passed while still holding CPUs.
+        bool        revived;    // Launched again after being retired.
+        bool        infeasible; // Provably unable to complete.
+        std::uint32_t version;  // Bumped on every change of workload.
     };
 
+    using slot_t = std::size_t;
+
     // Return time from when the task have done.
     auto time_policy(const TaskLaunch &launch) const -> double {
         const auto distance = get_time() - launch.start;
-        return oj::time_policy(distance, launch.cpu_cnt);
+        if (distance < cluster.start_up) return 0;
+        const auto effective_time = distance - cluster.start_up;
+        return effective_core[launch.cpu_cnt] * effective_time;
+    }
+
+    /**
+     * Return the slot of a task, or nullptr if the task has been retired.
+     * A retired task is free, unless saved too late, and its contribution
+     * is settled.
+     */
+    auto find_task(task_id_t task_id) -> TaskStatus * {
+        const auto iter = task_slot.find(task_id);
+        if (iter == task_slot.end()) return nullptr;
+        return &task_state[iter->second];
+    }
+
+    auto find_task(task_id_t task_id) const -> const TaskStatus * {
+        const auto iter = task_slot.find(task_id);
+        if (iter == task_slot.end()) return nullptr;
+        return &task_state[iter->second];
+    }
+
+    auto alloc_slot(TaskStatus status) -> slot_t {
+        slot_t slot;
+        if (free_slot.empty()) {
+            slot = task_state.size();
+            task_state.push_back(std::move(status));
+        } else {
+            slot = free_slot.back();
+            free_slot.pop_back();
+            task_state[slot] = std::move(status);
+        }
+        task_slot.emplace(task_state[slot].task_id, slot);
+        return slot;
+    }
+
+    /* Recycle the slot of a settled task. */
+    void retire(const TaskStatus &task) {
+        const auto iter = task_slot.find(task.task_id);
+        if (!task.revived)
+            this->notify([&](RuntimeListener &l) { l.on_retire(task.task_id); });
+        free_slot.push_back(iter->second);
+        task_slot.erase(iter);
+    }
+
+    template <typename _Fn>
+    void notify(_Fn &&fn) {
+        for (auto *listener : listeners) fn(*listener);
     }
 
     void launch_check(const Launch &command) const {
         const auto [cpu_cnt, task_id] = command;
         if (cpu_cnt == 0)
             panic("Launch: CPU count should not be zero.");
-        if (cpu_cnt > kCPUCount)
+        if (cpu_cnt > cluster.cpu_count)
             panic("Launch: CPU count exceeds the kMaxCPU limit.");
         if (task_id >= global_tasks)
             panic("Launch: Task ID out of range.");
-        const auto &workload = task_state[task_id].workload;
-        if (!holds_alternative <TaskFree> (workload))
+        const auto *task = find_task(task_id);
+        if (task != nullptr ? !holds_alternative <TaskFree> (task->workload)
+                            : stuck.contains(task_id))
             panic("Launch: Task is not free.");
     }
 
     // From free -> launch.
     void launch_commit(const Launch &command) {
         const auto [cpu_cnt, task_id] = command;
-        auto &workload = task_state[task_id].workload;
+        auto *task = find_task(task_id);
+
+        // A retired task may still occupy CPUs, though it can never complete.
+        if (task == nullptr) {
+            const auto slot = alloc_slot(TaskStatus {
+                .workload       = TaskFree {},
+                .time_passed    = 0,
+                .task_id        = task_id,
+                .deadline       = 0,
+                .execution_time = 0,
+                .priority       = 0,
+                .expired        = true,
+                .revived        = true,
+                .infeasible     = true,
+                .version        = 0,
+            });
+            task = &task_state[slot];
+        }
 
         this->cpu_usage += cpu_cnt;
 
-        workload = TaskLaunch {
+        task->workload = TaskLaunch {
             .cpu_cnt    = cpu_cnt,
             .start      = get_time(),
         };
+
+        this->notify([&](RuntimeListener &l) { l.on_launch(task_id, cpu_cnt, get_time()); });
+        this->index_task(*task);
     }
 
     void saving_check(const Saving &command) const {
@@ -101,8 +290,8 @@ private:
         if (task_id >= global_tasks)
             panic("Saving: Task ID out of range.");
 
-        const auto &workload = task_state[task_id].workload;
-        if (!holds_alternative <TaskLaunch> (workload))
+        const auto *task = find_task(task_id);
+        if (task == nullptr || !holds_alternative <TaskLaunch> (task->workload))
             panic("Saving: Task is not launched.");
     }
 
@@ -110,19 +299,22 @@ private:
     void saving_commit(const Saving &command) {
         const auto [task_id] = command;
 
-        auto &task = task_state[task_id];
+        auto &task = *find_task(task_id);
         auto &workload = task.workload;
         const auto &launch = get <TaskLaunch> (workload);
         const auto time_sum = this->time_policy(launch);
 
-        task_saving.insert(&task);
-
         auto [cpu_cnt, start] = launch;
         workload = TaskSaving {
             .cpu_cnt    = cpu_cnt,
-            .finish     = get_time() + kSaving,
+            .finish     = get_time() + cluster.saving,
             .time_passed = time_sum,
         };
+
+        task_saving.emplace(get_time() + cluster.saving, task_slot.at(task_id));
+
+        this->notify([&](RuntimeListener &l) { l.on_saving(task_id, get_time()); });
+        this->index_task(task);
     }
 
     void cancel_check(const Cancel &command) const {
@@ -133,8 +325,14 @@ private:
 
     void cancel_commit(const Cancel &command) {
         const auto [task_id] = command;
-        auto &task = task_state[task_id];
-        auto &workload = task.workload;
+        auto *task = find_task(task_id);
+        if (task == nullptr) {
+            // Retired, hence already free, or saved too late.
+            stuck.erase(task_id);
+            return;
+        }
+
+        auto &workload = task->workload;
 
         if (holds_alternative <TaskLaunch> (workload)) {
             // From launch -> free.
@@ -144,23 +342,82 @@ private:
             // From saving -> free.
             auto &saving = get <TaskSaving> (workload);
             this->cpu_usage -= saving.cpu_cnt;
-            this->task_saving.erase(&task);
+            this->task_saving.erase({ saving.finish, task_slot.at(task_id) });
+        } else {
+            return; // Already free.
         }
 
         workload = TaskFree {};
+        this->notify([&](RuntimeListener &l) { l.on_cancel(task_id, get_time()); });
+
+        if (task->expired)
+            this->retire(*task);
+        else
+            this->index_task(*task);
     }
 
     /* Counting all the tasks in this cycle. */
     auto get_new_tasks() -> std::vector <Task> {
-        auto &which = this->global_tasks;
-        const auto start = which;
+        std::vector <Task> result;
 
-        while (which < task_list.size()
-        && task_list[which].launch_time == get_time())
-            which += 1;
+        while (upcoming.has_value() && upcoming->launch_time == get_time()) {
+            const auto &task = *upcoming;
+            this->alloc_slot(TaskStatus {
+                .workload       = TaskFree {},
+                .time_passed    = 0,
+                .task_id        = global_tasks,
+                .deadline       = task.deadline,
+                .execution_time = task.execution_time,
+                .priority       = task.priority,
+                .expired        = false,
+                .revived        = false,
+                .infeasible     = false,
+                .version        = 0,
+            });
+            this->index_task(*find_task(global_tasks));
+            this->task_deadline.emplace(task.deadline, global_tasks);
+            this->service.total += task.priority;
+            this->notify([&](RuntimeListener &l) { l.on_arrive(global_tasks, task); });
+            this->global_tasks += 1;
+
+            result.push_back(task);
+            this->pull_task();
+        }
 
-        auto begin = task_list.begin();
-        return std::vector <Task> (begin + start, begin + which);
+        return result;
+    }
+
+    /* Fetch the next task from the source, which must be in order. */
+    void pull_task() {
+        const auto last = upcoming;
+        upcoming = source();
+        if (last.has_value() && upcoming.has_value()
+        && upcoming->launch_time < last->launch_time)
+            panic <SystemException> ("Task list is not sorted.");
+    }
+
+    /**
+     * Retire those free tasks whose deadline has passed.
+     * Tasks still holding CPUs are retired once they become free.
+     */
+    void retire_outdated() {
+        while (!task_deadline.empty()
+        && task_deadline.top().first < this->get_time()) {
+            const auto task_id = task_deadline.top().second;
+            task_deadline.pop();
+            auto *task = find_task(task_id);
+            if (task == nullptr) continue; // Saved too late, hence retired.
+            if (holds_alternative <TaskFree> (task->workload))
+                this->retire(*task);
+            else
+                task->expired = true;
+        }
+    }
+
+    static auto check_sorted(std::vector <Task> task_list) -> std::vector <Task> {
+        if (!std::ranges::is_sorted(task_list, {}, &Task::launch_time))
+            panic <SystemException> ("Task list is not sorted.");
+        return task_list;
     }
 
     void work(const Launch &command) {
@@ -178,55 +435,192 @@ private:
         this->cancel_commit(command);
     }
 
-    /* Remove those outdated saving file within.  */
-    void complete_this_cycle() {
-        auto begin = task_saving.begin();
-        auto finish = task_saving.end();
-
-        while (begin != finish) {
-            auto &task = **begin;
+    /* Complete the savings which finish no later than the time. */
+    void complete_saving(time_t time) {
+        while (!task_saving.empty() && task_saving.begin()->first <= time) {
+            const auto [finish, slot] = *task_saving.begin();
+            auto &task = task_state[slot];
             auto &workload = task.workload;
             auto &saving = get <TaskSaving> (workload);
 
-            if (saving.finish != this->get_time()) {
-                ++begin; continue;
-            }
-
             // From saving -> free.
 
             cpu_usage -= saving.cpu_cnt;
 
-            if (this->get_time() <= task.deadline) {
+            // Progress saved after the deadline is simply discarded.
+            const bool late = task.expired || finish > task.deadline;
+            if (!late) {
+                const bool done = time_t(task.time_passed) >= task.execution_time;
                 task.time_passed += saving.time_passed;
-                workload = TaskFree {};
+                if (!done && time_t(task.time_passed) >= task.execution_time) {
+                    service.complete += task.priority;
+                    this->notify([&](RuntimeListener &l) { l.on_complete(task.task_id); });
+                }
             }
 
-            begin = task_saving.erase(begin);
+            workload = TaskFree {};
+            task_saving.erase(task_saving.begin());
+            this->notify([&](RuntimeListener &l) { l.on_saved(task.task_id, finish); });
+
+            // As in the judge, a task saved too late is never free again,
+            // unless cancelled. It is settled, so retired all the same.
+            if (late) {
+                task.expired = true;
+                stuck.insert(task.task_id);
+            }
+
+            if (task.expired)
+                this->retire(task);
+            else
+                this->index_task(task);
+        }
+    }
+
+    /**
+     * The least count of ticks, on all the CPUs, for the progress to
+     * reach the execution time. Computed as the savings are added up.
+     */
+    auto least_ticks(const TaskStatus &task, double progress) const -> time_t {
+        const auto max_core = effective_core.max();
+        const auto target = double(task.execution_time);
+        if (progress >= target) return 0;
+        auto ticks = time_t(std::ceil((target - progress) / max_core));
+        while (ticks > 0 && progress + max_core * (ticks - 1) >= target) ticks -= 1;
+        while (progress + max_core * ticks < target) ticks += 1;
+        return ticks;
+    }
+
+    /**
+     * The earliest time when the task becomes provably infeasible, that
+     * is, even a single container on all the CPUs could not complete it.
+     * @return The time, or nullopt if it is complete or bound to be.
+     */
+    auto infeasible_time(const TaskStatus &task) const -> std::optional <time_t> {
+        const auto overhead = cluster.start_up + cluster.saving;
+        auto progress = task.time_passed;
+
+        // One tick after the latest launch that may complete the task.
+        auto infeasible_after = [&](double progress) -> std::optional <time_t> {
+            const auto ticks = this->least_ticks(task, progress);
+            if (ticks == 0) return std::nullopt;
+            if (task.deadline < overhead + ticks) return time_t(0);
+            return task.deadline - overhead - ticks + 1;
+        };
+
+        const auto &workload = task.workload;
+        if (holds_alternative <TaskLaunch> (workload)) {
+            const auto &launch = get <TaskLaunch> (workload);
+            if (this->least_ticks(task, progress) == 0) return std::nullopt;
+            // No saving after this one completes in time.
+            if (task.deadline < cluster.saving) return time_t(0);
+            const auto latest_save = task.deadline - cluster.saving;
+            const auto begin = launch.start + cluster.start_up;
+            const auto core = effective_core[launch.cpu_cnt];
+
+            // Progress of the container, if saved at the time.
+            auto gain = [&](time_t time) -> double {
+                time = std::min(time, latest_save);
+                return time > begin ? core * (time - begin) : 0;
+            };
+
+            // The container may complete it by itself, if saved by the latest.
+            if (this->least_ticks(task, progress + gain(latest_save)) == 0)
+                return latest_save + 1;
+
+            // Else it may be saved at any tick, with the progress so far,
+            // and launched again from the tick after the saving completes.
+            // The later, the worse, as the container gains no more than all
+            // the CPUs would. It may as well be cancelled and launched again.
+            auto too_late = [&](time_t time) -> bool {
+                const auto after = infeasible_after(progress + gain(time));
+                return after.has_value() && time + cluster.saving + 1 >= *after;
+            };
+            auto lo = launch.start, hi = latest_save + 1;
+            while (lo < hi) {
+                const auto mid = lo + (hi - lo) / 2;
+                if (too_late(mid)) hi = mid;
+                else lo = mid + 1;
+            }
+            return std::max(lo, *infeasible_after(progress));
+        } else if (holds_alternative <TaskSaving> (workload)) {
+            // Count on the saving, which only delays the result.
+            const auto &saving = get <TaskSaving> (workload);
+            if (saving.finish <= task.deadline) progress += saving.time_passed;
+        }
+
+        return infeasible_after(progress);
+    }
+
+    /* Index the task by the time it becomes infeasible. */
+    void index_task(TaskStatus &task) {
+        if (task.infeasible) return;
+        task.version += 1;
+        if (const auto time = this->infeasible_time(task))
+            task_feasible.push({ *time, task.task_id, task.version });
+    }
+
+    /* Collect the tasks which become infeasible by now. */
+    void detect_infeasible() {
+        infeasible.clear();
+        while (!task_feasible.empty() && task_feasible.top().time <= get_time()) {
+            const auto [time, task_id, version] = task_feasible.top();
+            task_feasible.pop();
+            auto *task = find_task(task_id);
+            if (task == nullptr || task->version != version) continue;
+
+            task->infeasible = true;
+            infeasible.push_back(task_id);
+            if (auto_cancel) this->cancel_commit({ task_id });
         }
     }
 
 public:
-    explicit RuntimeManager(std::vector <Task> task_list)
-        : global_clock(-1), global_tasks(0), cpu_usage(0), task_list(std::move(task_list)) {
-        if (!std::ranges::is_sorted(this->task_list, {}, &Task::launch_time))
-            panic <SystemException> ("Task list is not sorted.");
-        task_state.reserve(this->task_list.size());
-        for (auto &task : this->task_list)
-            task_state.push_back(TaskStatus {
-                .workload       = TaskFree {},
-                .time_passed    = 0,
-                .deadline       = task.deadline,
-            });
+    explicit RuntimeManager(std::vector <Task> task_list, const Cluster &cluster = {})
+        : RuntimeManager(make_source(check_sorted(std::move(task_list))), cluster) {}
+
+    /**
+     * @brief Pull tasks lazily from the source.
+     * Only tasks that may still change state are kept in memory,
+     * so memory scales with the live tasks rather than the total.
+     */
+    explicit RuntimeManager(TaskSource source, const Cluster &cluster = {})
+        : global_clock(-1), global_tasks(0), cpu_usage(0), cluster(cluster),
+          service { .complete = 0, .total = 0 }, effective_core(cluster.cpu_count),
+          source(std::move(source)) {
+        if (cluster.cpu_count == 0)
+            panic <SystemException> ("CPU count should not be zero.");
+        this->pull_task();
     }
 
     auto synchronize() -> std::vector <Task> {
-        this->complete_this_cycle();
+        return this->skip_to(global_clock + 1);
+    }
+
+    /**
+     * @brief Same as calling synchronize until the given time, with no
+     * policy in between. Only the savings that complete are visited, so
+     * idle time costs nothing. No task may arrive before the time.
+     * @return Tasks arriving at the time.
+     */
+    auto skip_to(time_t time) -> std::vector <Task> {
+        if (time < global_clock + 1)
+            panic <SystemException> ("Time should only go forward.");
+
+        this->complete_saving(get_time());
 
-        if (this->cpu_usage > kCPUCount)
+        if (this->cpu_usage > cluster.cpu_count)
             panic("CPU usage exceeds the limit.");
 
-        global_clock += 1;
-        return this->get_new_tasks();
+        if (upcoming.has_value() && upcoming->launch_time < time)
+            panic <SystemException> ("Time skips over arriving tasks.");
+
+        this->complete_saving(time - 1);
+
+        global_clock = time;
+        this->retire_outdated();
+        auto new_tasks = this->get_new_tasks();
+        this->detect_infeasible();
+        return new_tasks;
     }
 
     void work(std::vector <Policy> p) {
@@ -239,27 +633,139 @@ public:
         return global_clock;
     }
 
+    auto get_cluster() const -> const Cluster & {
+        return cluster;
+    }
+
     auto get_service_info() const -> ServiceInfo {
-        ServiceInfo result { .complete = 0, .total = 0 };
-        for (task_id_t id = 0; id < global_tasks; ++id) {
-            auto &state   = task_state[id];
-            auto &task    = task_list[id];
-            if (time_t(state.time_passed) >= task.execution_time) {
-                result.complete += task.priority;
-            }
-            result.total += task.priority;
+        return service;
+    }
+
+    auto get_cpu_usage() const -> cpu_id_t override {
+        return cpu_usage;
+    }
+
+    auto get_task(task_id_t task_id) const -> TaskView override {
+        if (task_id >= global_tasks)
+            panic("View: Task ID out of range.");
+
+        const auto *task = find_task(task_id);
+        if (task == nullptr)
+            return { .state = stuck.contains(task_id) ? WorkState::Saving : WorkState::Free,
+                     .cpu_cnt = 0, .time = 0, .progress = 0, .infeasible = true };
+
+        const auto &workload = task->workload;
+        TaskView result { .state = WorkState::Free, .cpu_cnt = 0, .time = 0,
+                          .progress = task->time_passed, .infeasible = task->infeasible };
+        if (holds_alternative <TaskLaunch> (workload)) {
+            const auto &launch = get <TaskLaunch> (workload);
+            result.state    = WorkState::Launch;
+            result.cpu_cnt  = launch.cpu_cnt;
+            result.time     = launch.start;
+        } else if (holds_alternative <TaskSaving> (workload)) {
+            const auto &saving = get <TaskSaving> (workload);
+            result.state    = WorkState::Saving;
+            result.cpu_cnt  = saving.cpu_cnt;
+            result.time     = saving.finish;
+        }
+        return result;
+    }
+
+    auto get_infeasible() const -> std::vector <task_id_t> override {
+        return infeasible;
+    }
+
+    /**
+     * @brief Cancel the containers of tasks as soon as they become
+     * infeasible, before the scheduler is called.
+     */
+    void set_auto_cancel(bool enable) {
+        auto_cancel = enable;
+    }
+
+    auto get_releases() const -> std::vector <Release> override {
+        std::vector <Release> result;
+        result.reserve(task_saving.size());
+        for (const auto &[finish, slot] : task_saving) {
+            const auto &saving = get <TaskSaving> (task_state[slot].workload);
+            result.push_back({ .time = saving.finish, .cpu_cnt = saving.cpu_cnt });
         }
         return result;
     }
 
+    /* Launch time of the next task to arrive, if any. */
+    auto get_next_arrival() const -> std::optional <time_t> {
+        if (!upcoming.has_value()) return std::nullopt;
+        return upcoming->launch_time;
+    }
+
+    /* When the next saving completes after the time, if any. */
+    auto get_next_release(time_t time) const -> std::optional <time_t> {
+        const auto iter = task_saving.upper_bound({ time, ~slot_t(0) });
+        if (iter == task_saving.end()) return std::nullopt;
+        return iter->first;
+    }
+
+    /**
+     * @return Tasks whose saving completes at the time, each with its
+     * progress after the saving. Progress saved too late is not counted.
+     */
+    auto get_completing(time_t time) const
+    -> std::vector <std::pair <task_id_t, double>> {
+        std::vector <std::pair <task_id_t, double>> result;
+        auto iter = task_saving.lower_bound({ time, 0 });
+        for (; iter != task_saving.end() && iter->first == time; ++iter) {
+            const auto &task = task_state[iter->second];
+            const auto &saving = get <TaskSaving> (task.workload);
+            auto progress = task.time_passed;
+            if (!task.expired && time <= task.deadline)
+                progress += saving.time_passed;
+            result.emplace_back(task.task_id, progress);
+        }
+        return result;
+    }
+
+    /* The listener must outlive the manager. */
+    void add_listener(RuntimeListener &listener) {
+        listeners.push_back(&listener);
+    }
+
+    /* Count of tasks kept in memory, including those yet to be retired. */
+    auto get_live_tasks() const -> std::size_t {
+        return task_slot.size();
+    }
+
 private:
     time_t      global_clock;   // A global clock to record the current time
     task_id_t   global_tasks;   // A global task ID counter.
     cpu_id_t    cpu_usage;      // The current CPU usage
-
-    const std::vector <Task> task_list;         // A list of tasks
-    std::vector <TaskStatus> task_state;        // A list of task status
-    std::unordered_set <TaskStatus *> task_saving; // A list of free tasks
+    const Cluster cluster;      // Parameters of the cluster
+    ServiceInfo service;        // Running totals of all the arrived tasks.
+    const EffectiveCore effective_core; // k^kAccel of each CPU count
+
+    std::vector <RuntimeListener *> listeners;  // Observers of the tasks
+    TaskSource source;                          // Where the tasks come from
+    std::optional <Task> upcoming;              // The next task to arrive
+    std::vector <TaskStatus> task_state;        // Slots of live task status
+    std::vector <slot_t> free_slot;             // Slots ready to be recycled
+    std::unordered_map <task_id_t, slot_t> task_slot;   // Task ID -> slot
+    std::set <std::pair <time_t, slot_t>> task_saving; // Savings by finish time
+    std::unordered_set <task_id_t> stuck;       // Retired, as saved too late
+
+    using Deadline = std::pair <time_t, task_id_t>;
+    std::priority_queue <Deadline, std::vector <Deadline>, std::greater <>>
+        task_deadline;                          // Live tasks by deadline
+
+    struct Feasible {
+        time_t          time;
+        task_id_t       task_id;
+        std::uint32_t   version;
+        auto operator <=> (const Feasible &) const = default;
+    };
+    std::priority_queue <Feasible, std::vector <Feasible>, std::greater <>>
+        task_feasible;                          // Tasks by infeasible time
+    std::vector <task_id_t> infeasible;         // Infeasible since last time
+    bool auto_cancel = false;                   // Cancel infeasible tasks
 };
 
 } // oj::detail::runtime
@@ -362,6 +868,21 @@ inline auto deserialize(std::istream &is) -> std::pair <Header, std::vector <Tas
     return { std::move(header), std::move(vec) };
 }
 
+/* Read only the header. The tasks are left in the stream for make_source. */
+inline auto deserialize_header(std::istream &is) -> Header {
+    Header header;
+
+    is.read(std::bit_cast <char *> (&header), sizeof(Header));
+
+    if (header.magic != header.kMagic)
+        panic <SystemException> ("System Error: Not handled in the spj!");
+
+    if (header.error_occur)
+        panic <SystemException> ("System Error: Not handled in the spj!");
+
+    return header;
+}
+
 template <typename _Tp>
 static bool within(_Tp x, Range <_Tp> range) {
     return range.min <= x && x <= range.max;
@@ -371,14 +892,18 @@ static void check_tasks(std::span <const Task> tasks, const Description &desc) {
     if (tasks.size() != desc.task_count)
         panic("The number of tasks is not equal to the number of tasks.");
 
+    if (desc.cpu_count == 0)
+        panic("The CPU count should not be zero.");
+
+    const auto max_core = std::pow(desc.cpu_count, oj::PublicInformation::kAccel);
+
     time_t execution_time_sum   = 0;
     priority_t priority_sum     = 0;
     for (const auto &task : tasks) {
         if (task.launch_time +
             oj::PublicInformation::kSaving +
             oj::PublicInformation::kStartUp +
-            (double)task.execution_time /
-            pow(oj::PublicInformation::kCPUCount, oj::PublicInformation::kAccel)
+            (double)task.execution_time / max_core
             >= task.deadline)
             panic("The task is impossible to finish.");
 
@@ -417,26 +942,123 @@ static auto generate_work(const Description &desc) -> std::vector <Task> {
     return tasks;
 }
 
-[[maybe_unused]]
-static auto schedule_work(const Description &desc, std::vector <Task> tasks)
--> ServiceInfo {
-    RuntimeManager manager { std::move(tasks) };
+/* The view given to the scheduler, only on the thread running the manager. */
+inline thread_local const RuntimeView *current_view = nullptr;
+
+/* Expose the manager to the scheduler within the scope. */
+struct ViewGuard {
+    explicit ViewGuard(const RuntimeView &view) : last(current_view) {
+        current_view = &view;
+    }
+    ~ViewGuard() { current_view = last; }
+
+private:
+    const RuntimeView *last;
+};
 
-    for (std::size_t i = 0; i <= desc.deadline_time.max; ++i) {
+/**
+ * @brief Hooks around each step of schedule_loop, called in the order
+ * below. A probe hides those it needs, and the rest compile to nothing.
+ * A probe that is also a RuntimeListener may add itself in on_start.
+ * The before_ hooks of the probes are called from the last probe, and
+ * the after_ hooks from the first, so that the first probe given is the
+ * innermost around each step, e.g. for timing it.
+ */
+struct Probe {
+    void on_start(RuntimeManager & /* manager */) {}
+    void before_synchronize(time_t /* time */) {}
+    void after_synchronize(time_t /* time */, const std::vector <Task> & /* list */) {}
+    void before_schedule(time_t /* time */) {}
+    void after_schedule(time_t /* time */, const std::vector <Policy> & /* policies */) {}
+    void before_work(time_t /* time */) {}
+    void after_work(time_t /* time */) {}
+    void on_finish(const RuntimeManager & /* manager */) {}
+};
+
+/* Call the function on each probe, from the last one to the first. */
+template <typename _Fn, typename ..._Probe>
+static void for_each_reversed(_Fn &&fn, _Probe &...probe) {
+    const auto probes = std::tie(probe...);
+    [&] <std::size_t ..._Index> (std::index_sequence <_Index...>) {
+        (fn(std::get <sizeof...(_Probe) - 1 - _Index> (probes)), ...);
+    } (std::index_sequence_for <_Probe...> {});
+}
+
+/* Schedules a tick, e.g. schedule_tasks. */
+using TickScheduler = std::function <std::vector <Policy> (time_t, std::vector <Task>, const Description &)>;
+
+/**
+ * @brief Same as schedule_loop, but each tick is scheduled by the given
+ * callable, with the same signature as schedule_tasks. The loop goes on
+ * from the tick after the time of the manager, i.e. from 0 if fresh.
+ */
+template <typename _Scheduler, typename ..._Probe>
+static auto schedule_loop_with(const Description &desc, RuntimeManager &manager,
+    _Scheduler &&scheduler, _Probe &...probe) -> ServiceInfo {
+    const ViewGuard guard { manager };
+
+    (probe.on_start(manager), ...);
+
+    for (auto i = manager.get_time() + 1; i <= desc.deadline_time.max; ++i) {
+        for_each_reversed([i](auto &p) { p.before_synchronize(i); }, probe...);
         auto new_tasks = manager.synchronize();
         if (i != manager.get_time())
             panic <SystemException> ("Time is not synchronized");
-        manager.work(schedule_tasks(i, std::move(new_tasks), desc));
+        (probe.after_synchronize(i, new_tasks), ...);
+        for_each_reversed([i](auto &p) { p.before_schedule(i); }, probe...);
+        auto policies = scheduler(i, std::move(new_tasks), desc);
+        (probe.after_schedule(i, policies), ...);
+        for_each_reversed([i](auto &p) { p.before_work(i); }, probe...);
+        manager.work(std::move(policies));
+        (probe.after_work(i), ...);
     }
 
     manager.synchronize();
 
+    (probe.on_finish(manager), ...);
+
     return manager.get_service_info();
 }
 
+template <typename ..._Probe>
+static auto schedule_loop(const Description &desc, RuntimeManager &manager, _Probe &...probe)
+-> ServiceInfo {
+    return schedule_loop_with(desc, manager, [](time_t time, std::vector <Task> list,
+        const Description &desc) { return schedule_tasks(time, std::move(list), desc); }, probe...);
+}
+
+template <typename ..._Probe>
+static auto schedule_work(const Description &desc, std::vector <Task> tasks, _Probe &...probe)
+-> ServiceInfo {
+    RuntimeManager manager { std::move(tasks), { .cpu_count = desc.cpu_count } };
+    return schedule_loop(desc, manager, probe...);
+}
+
+/**
+ * @brief Same as schedule_work, but tasks are pulled lazily from the source,
+ * e.g. make_source(is, header.task_count) after deserialize_header(is).
+ */
+template <typename ..._Probe>
+static auto schedule_stream(const Description &desc, TaskSource source, _Probe &...probe)
+-> ServiceInfo {
+    RuntimeManager manager { std::move(source), { .cpu_count = desc.cpu_count } };
+    return schedule_loop(desc, manager, probe...);
+}
+
 enum class JudgeResult {
     GenerateFailed,
     ScheduleFailed,
 };
 
-} // namespace oj::detail::runtime
\ No newline at end of file
+} // namespace oj::detail::runtime
+
+namespace oj {
+
+inline auto runtime_view() -> const RuntimeView & {
+    using detail::runtime::current_view;
+    if (current_view == nullptr)
+        detail::runtime::panic("View: Not within schedule_tasks.");
+    return *current_view;
+}
+
+} // namespace oj
\ No newline at end of file
@@ -24,12 +24,12 @@ namespace oj {
 namespace oj {
   std::queue<std::pair<size_t, Task>> q;
   task_id_t task_id = 0;
-  bool free[PublicInformation::kCPUCount];
-  size_t free_cpu = PublicInformation::kCPUCount;
+  size_t free_cpu = 0;
   std::map<size_t, std::vector<size_t>> savings;
 
   auto schedule_tasks(time_t time, std::vector<Task> list, const Description &desc) -> std::vector<Policy> {
     std::vector<Policy> ret;
+    if (time == 0) free_cpu = desc.cpu_count;
     for (size_t i = 0; i < list.size(); i++) {
       q.emplace(task_id + i, list[i]);
     }
@@ -0,0 +1,96 @@
+/**
+ * Sub-sampled SLO estimation with confidence intervals.
+ *
+ * Usage: subsample [-f fraction] [-n samples] [-k strata] [-s seed]
+ *                  [-j jobs] [-c] <dataset>...
+ * A dataset is either a file serialized by client.cpp,
+ * or the index (0 ~ 3) of a preset in testcase_array.
+ * With -c, each dataset is also spot-checked by a full run, and flagged
+ * when the full SLO falls outside the 95% confidence interval. The full
+ * run takes one of the -j jobs.
+ */
+#include "runtime.h"
+#include "subsample.h"
+#include "src.hpp"
+#include <thread>
+
+namespace oj::detail::runtime {
+
+struct SubsampleOptions {
+    double          fraction    = 0.1;
+    std::size_t     samples     = 16;
+    std::size_t     strata      = 10;
+    std::uint64_t   seed        = 114514;
+    std::size_t     parallel    = std::thread::hardware_concurrency();
+    bool            check       = false;
+};
+
+static auto subsample(const SubsampleOptions &options, const std::string &name) -> bool {
+    auto [desc, tasks] = load_dataset(name);
+
+    auto full_run = [&]() -> double {
+        return slo_rate(schedule_work(desc, tasks));
+    };
+
+    // The full run goes along with the subsamples, if a job is left.
+    std::optional <Isolated <double>> full;
+    auto parallel = std::max <std::size_t> (options.parallel, 1);
+    if (options.check && parallel > 1) {
+        full = spawn_isolated(full_run);
+        parallel -= 1;
+    }
+
+    const auto [mean, lower, upper] = estimate_slo(
+        desc, tasks, options.fraction, options.samples,
+        options.strata, options.seed, parallel);
+
+    std::cout << std::fixed << std::setprecision(6)
+              << name << " slo " << mean
+              << " ci95 [" << lower << ", " << upper << "]";
+
+    bool agree = true;
+    if (options.check) {
+        const auto slo = full.has_value() ? join_isolated(*full) : run_isolated(full_run);
+        agree = lower <= slo && slo <= upper;
+        std::cout << " full " << slo << (agree ? "" : " DISAGREE");
+    }
+
+    std::cout << std::endl;
+    return agree;
+}
+
+} // namespace oj::detail::runtime
+
+signed main(int argc, char *argv[]) {
+    oj::detail::runtime::SubsampleOptions options;
+    std::vector <std::string> names;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "-f" && has_value)       options.fraction = std::stod(argv[++i]);
+        else if (arg == "-n" && has_value)  options.samples  = std::stoul(argv[++i]);
+        else if (arg == "-k" && has_value)  options.strata   = std::stoul(argv[++i]);
+        else if (arg == "-s" && has_value)  options.seed     = std::stoull(argv[++i]);
+        else if (arg == "-j" && has_value)  options.parallel = std::stoul(argv[++i]);
+        else if (arg == "-c")               options.check    = true;
+        else names.emplace_back(arg);
+    }
+
+    if (names.empty()) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [-f fraction] [-n samples] [-k strata] [-s seed]"
+                     " [-j jobs] [-c] <dataset>...\n";
+        return 1;
+    }
+
+    bool agree = true;
+    try {
+        for (const auto &name : names)
+            agree &= oj::detail::runtime::subsample(options, name);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return agree ? 0 : 2;
+}
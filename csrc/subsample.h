@@ -0,0 +1,191 @@
+#pragma once
+#include "runtime.h"
+#include "harness.h"
+#include <random>
+#include <numeric>
+
+/**
+ * Sub-sampled SLO estimation.
+ * A subset with a fraction f of the tasks is simulated on a cluster
+ * with f of the CPUs, so that the load stays about the same. The CPUs
+ * are rounded to a whole count first, and f follows them. A sampled
+ * task too large for the scaled cluster is left out of the simulation,
+ * and counted as a miss.
+ */
+namespace oj::detail::runtime {
+
+/**
+ * @brief Sample a fraction of the tasks, stratified by priority.
+ * Within a stratum, tasks are taken systematically in launch order from
+ * a random offset, which also spreads the sample evenly over time.
+ * @return The sampled tasks, sorted by launch_time.
+ */
+template <typename _Rng>
+auto stratified_sample(
+    std::span <const Task> tasks, double fraction, std::size_t strata, _Rng &rng)
+-> std::vector <Task> {
+    std::vector <std::size_t> order(tasks.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_sort(order, {}, [&](std::size_t i) { return tasks[i].priority; });
+
+    const auto stride = 1 / fraction;
+    std::uniform_real_distribution <double> offset { 0, stride };
+
+    std::vector <std::size_t> chosen;
+    strata = std::clamp <std::size_t> (strata, 1, std::max <std::size_t> (tasks.size(), 1));
+    for (std::size_t s = 0; s < strata; ++s) {
+        const auto begin = order.begin() + tasks.size() * s / strata;
+        const auto end   = order.begin() + tasks.size() * (s + 1) / strata;
+        std::sort(begin, end);  // Back to launch order.
+        for (double i = offset(rng); i < end - begin; i += stride)
+            chosen.push_back(begin[std::size_t(i)]);
+    }
+
+    std::ranges::sort(chosen);
+    std::vector <Task> result;
+    result.reserve(chosen.size());
+    for (const auto i : chosen) result.push_back(tasks[i]);
+    return result;
+}
+
+/* The fraction of the CPUs kept, as a whole count and at least one. */
+inline auto scaled_fraction(const Description &desc, double fraction) -> double {
+    const auto cpu_count = std::max <cpu_id_t> (std::llround(desc.cpu_count * fraction), 1);
+    return std::min(double(cpu_count) / desc.cpu_count, 1.0);
+}
+
+/**
+ * @brief The description of a subsample. The cluster is scaled down with
+ * the task count, and the sum ranges are relaxed, as they do not survive
+ * sampling. The per-task ranges are kept.
+ */
+inline auto subsample_description(
+    const Description &desc, std::span <const Task> sample, double fraction)
+-> Description {
+    auto result = desc;
+    const auto cpu_count = std::llround(desc.cpu_count * fraction);
+    result.cpu_count  = std::max <cpu_id_t> (cpu_count, 1);
+    result.task_count = sample.size();
+    result.execution_time_sum   = { .min = 0, .max = ~time_t(0) };
+    result.priority_sum         = { .min = 0, .max = ~priority_t(0) };
+    return result;
+}
+
+/* Whether the task may finish on the cluster, by the bound of check_tasks. */
+inline auto fits_cluster(const Task &task, cpu_id_t cpu_count) -> bool {
+    const auto max_core = std::pow(cpu_count, PublicInformation::kAccel);
+    return task.launch_time + PublicInformation::kSaving + PublicInformation::kStartUp
+        + double(task.execution_time) / max_core < task.deadline;
+}
+
+/**
+ * @brief The SLO rate of a subsample, with the tasks which do not fit
+ * the scaled cluster counted as misses.
+ */
+[[maybe_unused]]
+static auto simulate_subsample(const Description &desc, std::vector <Task> sample, double fraction)
+-> double {
+    auto sub = subsample_description(desc, sample, fraction);
+    priority_t dropped = 0;
+    std::erase_if(sample, [&](const Task &task) {
+        if (fits_cluster(task, sub.cpu_count)) return false;
+        dropped += task.priority;
+        return true;
+    });
+    sub.task_count = sample.size();
+    check_tasks(sample, sub);
+
+    const auto info = schedule_work(sub, std::move(sample));
+    return slo_rate({ .complete = info.complete, .total = info.total + dropped });
+}
+
+struct Interval {
+    double mean;
+    double lower;
+    double upper;
+};
+
+/* A 95% confidence interval of the mean, by Student's t-distribution. */
+inline auto confidence_interval(std::span <const double> values) -> Interval {
+    static constexpr double kStudent[] = {
+        0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+        2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+        2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045,
+        2.042,
+    };
+
+    const auto n = values.size();
+    if (n < 2)
+        panic <SystemException> ("An interval needs at least two samples.");
+    const auto mean = std::accumulate(values.begin(), values.end(), 0.0) / n;
+    double variance = 0;
+    for (const auto x : values) variance += (x - mean) * (x - mean);
+    variance /= n - 1;
+
+    const auto t = n - 1 < std::size(kStudent) ? kStudent[n - 1] : 1.960;
+    const auto half = t * std::sqrt(variance / n);
+    return { mean, mean - half, mean + half };
+}
+
+/**
+ * A 95% Wilson score interval of a rate, as if from `size` independent
+ * tasks. Unlike the t-interval, it keeps a width when the rate is 0 or 1.
+ */
+inline auto wilson_interval(double rate, double size) -> Interval {
+    constexpr double z = 1.960;
+    const auto z2 = z * z / size;
+    const auto center = (rate + z2 / 2) / (1 + z2);
+    const auto half = z / (1 + z2) * std::sqrt(rate * (1 - rate) / size + z2 / (4 * size));
+    return { rate, center - half, center + half };
+}
+
+/* Count of tasks of equal priority, which weigh as much as the tasks. */
+inline auto effective_size(std::span <const Task> tasks) -> double {
+    double sum = 0, square = 0;
+    for (const auto &task : tasks) {
+        sum += task.priority;
+        square += double(task.priority) * task.priority;
+    }
+    return square == 0 ? 0 : sum * sum / square;
+}
+
+/**
+ * @brief Estimate the SLO rate from `samples` subsamples, simulated
+ * in parallel by at most `parallel` processes. The subsamples may all
+ * agree, e.g. on identical tasks, so the interval is no narrower than
+ * by the binomial variance of the tasks sampled, with the finite
+ * population correction.
+ */
+[[maybe_unused]]
+static auto estimate_slo(
+    const Description &desc, std::span <const Task> tasks,
+    double fraction, std::size_t samples, std::size_t strata,
+    std::uint64_t seed, std::size_t parallel)
+-> Interval {
+    if (!(fraction > 0 && fraction <= 1))
+        panic <SystemException> ("The fraction should be within (0, 1].");
+    if (samples < 2)
+        panic <SystemException> ("At least two samples are needed.");
+
+    fraction = scaled_fraction(desc, fraction);
+    std::vector <std::function <double ()>> jobs;
+    for (std::size_t i = 0; i < samples; ++i) {
+        jobs.push_back([=, &desc]() -> double {
+            std::mt19937_64 rng { seed + i };
+            auto sample = stratified_sample(tasks, fraction, strata, rng);
+            return simulate_subsample(desc, std::move(sample), fraction);
+        });
+    }
+
+    const auto slo = run_parallel <double> (jobs, parallel);
+    auto result = confidence_interval(slo);
+    if (fraction < 1) {
+        const auto size = samples * fraction * effective_size(tasks) / (1 - fraction);
+        const auto floor = wilson_interval(result.mean, size);
+        result.lower = std::min(result.lower, floor.lower);
+        result.upper = std::max(result.upper, floor.upper);
+    }
+    return result;
+}
+
+} // namespace oj::detail::runtime
@@ -0,0 +1,100 @@
+/**
+ * Sweep task count, CPU count and horizon on a geometric grid, and print
+ * the throughput of each point as one JSON object per line.
+ *
+ * Usage: sweep [-t min:max] [-c min:max] [-d min:max] [-x factor]
+ *              [-m work|stream] [-s seed]
+ * The scheduler is src.hpp, unless built with -DOJ_SCHEDULER='"other.hpp"'.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "sweep.h"
+#ifdef OJ_SCHEDULER
+#include OJ_SCHEDULER
+#else
+#include "src.hpp"
+#endif
+
+namespace oj::detail::runtime {
+
+static auto make_runner(std::string_view mode) -> SweepRunner {
+    if (mode == "work")
+        return [](const Description &desc, std::vector <Task> tasks) {
+            return schedule_work(desc, std::move(tasks));
+        };
+    if (mode == "stream")
+        return [](const Description &desc, std::vector <Task> tasks) {
+            return schedule_stream(desc, make_source(std::move(tasks)));
+        };
+    panic <SystemException> ("Sweep: Unknown mode " + std::string(mode));
+}
+
+template <typename _Tp>
+static auto parse_range(std::string_view arg) -> std::pair <_Tp, _Tp> {
+    const auto colon = arg.find(':');
+    const auto min = std::stoull(std::string(arg.substr(0, colon)));
+    const auto max = colon == arg.npos ? min : std::stoull(std::string(arg.substr(colon + 1)));
+    return { _Tp(min), _Tp(max) };
+}
+
+} // namespace oj::detail::runtime
+
+signed main(int argc, char *argv[]) {
+    using namespace oj::detail::runtime;
+
+    std::pair <oj::task_id_t, oj::task_id_t> tasks = { 1000, 100000 };
+    std::pair <oj::cpu_id_t, oj::cpu_id_t> cpus = { 32, 512 };
+    std::pair <oj::time_t, oj::time_t> horizon = { 10000, 1000000 };
+    double factor = 10;
+    std::string_view mode = "work";
+    std::uint64_t seed = 1;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            if (i + 1 == argc) throw std::invalid_argument("Missing value.");
+            if (arg == "-t") tasks = parse_range <oj::task_id_t> (argv[++i]);
+            else if (arg == "-c") cpus = parse_range <oj::cpu_id_t> (argv[++i]);
+            else if (arg == "-d") horizon = parse_range <oj::time_t> (argv[++i]);
+            else if (arg == "-x") factor = std::stod(argv[++i]);
+            else if (arg == "-m") mode = argv[++i];
+            else if (arg == "-s") seed = std::stoull(argv[++i]);
+            else throw std::invalid_argument("Unknown option.");
+        }
+    } catch (const std::exception &) {
+        std::cerr << "Usage: " << argv[0] << " [-t min:max] [-c min:max] [-d min:max]"
+                     " [-x factor] [-m work|stream] [-s seed]\n";
+        return 1;
+    }
+
+    try {
+        const auto runner = make_runner(mode);
+        for (const auto task_count : geometric_grid(tasks.first, tasks.second, factor))
+        for (const auto cpu_count : geometric_grid(cpus.first, cpus.second, factor))
+        for (const auto max_time : geometric_grid(horizon.first, horizon.second, factor)) {
+            const SweepPoint point = {
+                .task_count = task_count,
+                .cpu_count  = cpu_count,
+                .horizon    = max_time,
+            };
+            const auto result = run_sweep_point(point, runner, seed);
+            // The runtime synchronizes once more after the last tick.
+            const auto ticks = double(max_time) + 2;
+            std::cout << std::fixed << std::setprecision(3)
+                      << R"({"mode":")" << mode
+                      << R"(","tasks":)" << task_count
+                      << R"(,"cpus":)" << cpu_count
+                      << R"(,"horizon":)" << max_time
+                      << R"(,"seconds":)" << result.seconds
+                      << R"(,"ticks_per_sec":)" << ticks / result.seconds
+                      << R"(,"tasks_per_sec":)" << task_count / result.seconds
+                      << R"(,"peak_rss_mib":)" << result.peak_rss / double(1 << 20)
+                      << R"(,"slo":)" << slo_rate(result.info)
+                      << "}" << std::endl;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "runtime.h"
+#include "harness.h"
+#include <chrono>
+#include <random>
+#include <sys/resource.h>
+
+/**
+ * Scaling sweeps: descriptions are synthesized on a geometric grid of
+ * task count, CPU count and deadline horizon, each with a random task set
+ * which passes check_tasks. A run times the scheduling end to end, with
+ * the runner given, in a fresh process.
+ */
+namespace oj::detail::runtime {
+
+struct SweepPoint {
+    task_id_t   task_count;
+    cpu_id_t    cpu_count;
+    time_t      horizon;    // Max deadline
+};
+
+struct SweepResult {
+    SweepPoint      point;
+    ServiceInfo     info;
+    double          seconds;
+    std::uint64_t   peak_rss;   // In bytes, including the task set
+};
+
+/* Schedules a task set, e.g. schedule_work. */
+using SweepRunner = std::function <ServiceInfo (const Description &, std::vector <Task>)>;
+
+/* The values from min to max, multiplied by factor each step. */
+template <typename _Tp>
+inline auto geometric_grid(_Tp min, _Tp max, double factor) -> std::vector <_Tp> {
+    if (min == 0 || factor <= 1)
+        panic <SystemException> ("Sweep: Grid should start above zero and grow.");
+    std::vector <_Tp> result;
+    for (double value = min; value <= double(max) * (1 + 1e-9); value *= factor)
+        result.push_back(_Tp(std::llround(value)));
+    return result;
+}
+
+/**
+ * @brief A description that fits the point. Each task runs up to a tenth
+ * of the horizon, on a single CPU, and the sums are left unconstrained.
+ */
+inline auto synthesize_description(const SweepPoint &point) -> Description {
+    constexpr time_t kOverhead = PublicInformation::kStartUp + PublicInformation::kSaving;
+    if (point.horizon <= 2 * (kOverhead + 1))
+        panic <SystemException> ("Sweep: Horizon is too short.");
+
+    const auto execution_max = std::max <time_t> (1, point.horizon / 10);
+    constexpr priority_t kPriority = 1000;
+    return Description {
+        .cpu_count              = point.cpu_count,
+        .task_count             = point.task_count,
+        .deadline_time          = { .min = 1, .max = point.horizon },
+        .execution_time_single  = { .min = 1, .max = execution_max },
+        .execution_time_sum     = { .min = 0, .max = execution_max * point.task_count },
+        .priority_single        = { .min = 1, .max = kPriority },
+        .priority_sum           = { .min = 0, .max = kPriority * point.task_count },
+    };
+}
+
+/* Uniform random tasks, each feasible by itself, sorted by launch_time. */
+inline auto synthesize_tasks(const Description &desc, std::uint64_t seed) -> std::vector <Task> {
+    constexpr time_t kOverhead = PublicInformation::kStartUp + PublicInformation::kSaving;
+    const auto max_core = std::pow(desc.cpu_count, PublicInformation::kAccel);
+    const auto horizon = desc.deadline_time.max;
+
+    std::mt19937_64 rng { seed };
+    auto uniform = [&rng](auto min, auto max) {
+        return std::uniform_int_distribution <decltype(min)> { min, max } (rng);
+    };
+
+    std::vector <Task> tasks;
+    tasks.reserve(desc.task_count);
+    for (task_id_t i = 0; i < desc.task_count; ++i) {
+        const auto execution_time = uniform(desc.execution_time_single.min, desc.execution_time_single.max);
+        // Same bound as check_tasks, with one tick to spare.
+        const auto least = kOverhead + time_t(std::ceil(execution_time / max_core)) + 1;
+        const auto launch_time = uniform(time_t(0), horizon - least);
+        tasks.push_back(Task {
+            .launch_time    = launch_time,
+            .deadline       = uniform(launch_time + least, horizon),
+            .execution_time = execution_time,
+            .priority       = uniform(desc.priority_single.min, desc.priority_single.max),
+        });
+    }
+
+    std::ranges::sort(tasks, {}, &Task::launch_time);
+    check_tasks(tasks, desc);
+    return tasks;
+}
+
+/* Synthesize and run one point, in a fresh process. */
+[[maybe_unused]]
+static auto run_sweep_point(const SweepPoint &point, const SweepRunner &runner, std::uint64_t seed)
+-> SweepResult {
+    return run_isolated([&]() -> SweepResult {
+        using clock = std::chrono::steady_clock;
+        const auto desc = synthesize_description(point);
+        auto tasks = synthesize_tasks(desc, seed);
+
+        const auto start = clock::now();
+        const auto info = runner(desc, std::move(tasks));
+        const auto seconds = std::chrono::duration <double> (clock::now() - start).count();
+
+        rusage usage {};
+        ::getrusage(RUSAGE_SELF, &usage);
+        return SweepResult {
+            .point      = point,
+            .info       = info,
+            .seconds    = seconds,
+            .peak_rss   = std::uint64_t(usage.ru_maxrss) * 1024,
+        };
+    });
+}
+
+} // namespace oj::detail::runtime
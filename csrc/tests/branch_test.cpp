@@ -0,0 +1,60 @@
+/**
+ * Branches from the middle of a recorded run hand the rest over cleanly:
+ * no container of the prefix is launched again while running, and the
+ * scheduler taking over does better than doing nothing.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "budget.h"
+#include "branch.h"
+#include "src.hpp"
+#include "check.h"
+#include <sstream>
+
+using namespace oj::detail::runtime;
+using oj::detail::test::check;
+
+static auto make_scheduler(std::string_view name) -> TickScheduler {
+    if (name == "idle") return idle_fallback();
+    return [](oj::time_t time, std::vector <oj::Task> list, const oj::Description &desc) {
+        return oj::schedule_tasks(time, std::move(list), desc);
+    };
+}
+
+signed main() {
+    const auto path = std::filesystem::temp_directory_path()
+        / ("branch_test." + std::to_string(::getpid()) + ".bin");
+
+    for (const auto *dataset : { "1", "3" }) {
+        // Recorded in a child, so that the scheduler here stays fresh.
+        const auto recorded = run_isolated([&]() -> ServiceInfo {
+            auto [desc, tasks] = load_dataset(dataset);
+            std::ofstream file { path, std::ios::binary };
+            PolicyRecorder recorder { file };
+            return schedule_work(desc, std::move(tasks), recorder);
+        });
+
+        std::vector <Branch> branches;
+        for (const oj::time_t tick : { 0, 100, 2000, 5000, 50000 }) {
+            branches.push_back({ .tick = tick, .scheduler = "primary" });
+            branches.push_back({ .tick = tick, .scheduler = "idle" });
+        }
+
+        auto [desc, tasks] = load_dataset(dataset);
+        std::ifstream trace { path, std::ios::binary };
+        const auto [replayed, results] = run_branches(desc, std::move(tasks), trace, branches, make_scheduler, 2);
+
+        check(replayed.complete == recorded.complete, "The trace replays as recorded.");
+        check(results[0].info.complete == recorded.complete, "A branch at tick 0 is the same run.");
+        for (std::size_t i = 2; i < results.size(); i += 2) {
+            const auto &primary = results[i].info;
+            const auto &idle = results[i + 1].info;
+            check(primary.total == idle.total, "Branches see the same tasks.");
+            check(primary.complete > idle.complete, "The scheduler taking over does better than idle.");
+        }
+    }
+
+    std::filesystem::remove(path);
+    std::cout << "branch_test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * A fallback which launches what it is given takes over a run with the
+ * containers of the primary still running, without ever launching a
+ * task which is not free, nor using more CPUs than the cluster has.
+ */
+#include "runtime.h"
+#include "budget.h"
+#include "check.h"
+#include <deque>
+#include <map>
+#include <thread>
+
+using namespace oj::detail::runtime;
+using oj::detail::test::check;
+
+/**
+ * Launch each task on one CPU as soon as one is free, and save it once
+ * done. Free CPUs are counted from the description, not the view.
+ */
+static auto greedy(std::size_t *launches = nullptr) -> TickScheduler {
+    struct State {
+        std::deque <std::pair <oj::task_id_t, oj::Task>> queue;
+        std::map <oj::time_t, std::vector <oj::task_id_t>> savings;
+        std::map <oj::time_t, oj::cpu_id_t> releases;
+        oj::task_id_t next_id = 0;
+        oj::cpu_id_t used = 0;
+    };
+    return [state = std::make_shared <State> (), launches]
+        (oj::time_t time, std::vector <oj::Task> list, const oj::Description &desc) {
+        auto &[queue, savings, releases, next_id, used] = *state;
+        std::vector <oj::Policy> policies;
+        for (const auto &task : list) queue.emplace_back(next_id++, task);
+        for (auto iter = releases.begin(); iter != releases.end() && iter->first <= time;)
+            used -= iter->second, iter = releases.erase(iter);
+        if (auto iter = savings.find(time); iter != savings.end()) {
+            for (const auto task_id : iter->second)
+                policies.push_back(oj::Saving { .task_id = task_id });
+            releases[time + oj::PublicInformation::kSaving + 1] += iter->second.size();
+            savings.erase(iter);
+        }
+        while (!queue.empty() && used < desc.cpu_count) {
+            const auto [task_id, task] = queue.front();
+            queue.pop_front();
+            if (time + oj::PublicInformation::kStartUp + task.execution_time
+                + oj::PublicInformation::kSaving > task.deadline) continue;
+            policies.push_back(oj::Launch { .cpu_cnt = 1, .task_id = task_id });
+            savings[time + oj::PublicInformation::kStartUp + task.execution_time].push_back(task_id);
+            used += 1;
+            if (launches != nullptr) *launches += 1;
+        }
+        return policies;
+    };
+}
+
+signed main() {
+    constexpr oj::time_t kSlowTick = 50;
+
+    oj::Description desc = oj::small;
+    desc.cpu_count = 4;
+    desc.deadline_time.max = 400;
+    std::vector <oj::Task> tasks;
+    for (oj::time_t time = 0; time < 300; time += 2)
+        tasks.push_back({ .launch_time = time, .deadline = time + 80,
+                          .execution_time = 10, .priority = 1 });
+
+    // The primary runs over the tick budget once, with containers running.
+    auto primary = [inner = greedy()](oj::time_t time, std::vector <oj::Task> list,
+        const oj::Description &desc) mutable {
+        if (time == kSlowTick) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return inner(time, std::move(list), desc);
+    };
+
+    std::size_t launches = 0;
+    BudgetedScheduler scheduler {
+        { .per_tick = std::chrono::milliseconds(20) }, primary, greedy(&launches),
+    };
+    RuntimeManager manager { tasks, { .cpu_count = desc.cpu_count } };
+    const auto info = schedule_loop_with(desc, manager, scheduler);
+
+    check(scheduler.handoff == kSlowTick, "handed over at the slow tick");
+    check(launches > 0, "the fallback launches tasks");
+    // As many tasks arrive before the slow tick.
+    check(info.complete > kSlowTick / 2, "the fallback completes tasks after the handover");
+    std::cout << "budget_test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdlib>
+#include <iostream>
+#include <source_location>
+#include <string_view>
+
+/**
+ * Checks for the tests. Each test is a program of its own, which exits
+ * with failure on the first check that fails, e.g.
+ *   g++ -std=c++20 -O2 -I csrc csrc/tests/branch_test.cpp && ./a.out
+ */
+namespace oj::detail::test {
+
+inline void check(bool condition, std::string_view what,
+    std::source_location where = std::source_location::current()) {
+    if (condition) return;
+    std::cerr << where.file_name() << ':' << where.line() << ": Check failed: " << what << std::endl;
+    std::exit(EXIT_FAILURE);
+}
+
+} // namespace oj::detail::test
@@ -0,0 +1,62 @@
+/**
+ * Compact tasks round-trip every preset exactly, and a run fed from a
+ * compact list serves it the same as one fed the full tasks.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "compact.h"
+#include "src.hpp"
+#include "check.h"
+
+using namespace oj::detail::runtime;
+using oj::detail::test::check;
+
+static_assert(sizeof(oj::Task) == 32);
+static_assert(sizeof(compact_task_t <oj::small>)  == 8);
+static_assert(sizeof(compact_task_t <oj::middle>) == 16);
+static_assert(sizeof(compact_task_t <oj::senpai>) == 16);
+static_assert(sizeof(compact_task_t <oj::huge>)   == 16);
+
+static auto same(const oj::Task &lhs, const oj::Task &rhs) -> bool {
+    return lhs.launch_time == rhs.launch_time && lhs.deadline == rhs.deadline
+        && lhs.execution_time == rhs.execution_time && lhs.priority == rhs.priority;
+}
+
+template <oj::Description _Desc>
+static void check_preset(std::string_view name) {
+    const auto what = std::string(name) + ": ";
+    const auto tasks = generate_work(_Desc);
+    const auto compact = compact_list <_Desc> (tasks);
+    const auto expanded = expand_list(compact);
+    check(std::ranges::equal(tasks, expanded, same), what + "round trip");
+
+    // Each in a child, as the scheduler keeps its state in globals.
+    const auto expected = run_isolated([&]() -> ServiceInfo {
+        return schedule_work(_Desc, tasks);
+    });
+    const auto actual = run_isolated([&]() -> ServiceInfo {
+        return schedule_stream(_Desc, make_source(compact));
+    });
+    check(actual.complete == expected.complete && actual.total == expected.total,
+        what + "same service from the compact source");
+}
+
+signed main() {
+    check_preset <oj::small>  ("small");
+    check_preset <oj::middle> ("middle");
+    check_preset <oj::senpai> ("senpai");
+    check_preset <oj::huge>   ("huge");
+
+    // A task beyond the description does not fit.
+    bool refused = false;
+    try {
+        to_compact <compact_task_t <oj::small>> ({ .launch_time = 0, .deadline = 1 << 16,
+            .execution_time = 1, .priority = 1 });
+    } catch (const OJException &) {
+        refused = true;
+    }
+    check(refused, "a task too large for the compact type is refused");
+
+    std::cout << "compact_test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,94 @@
+/**
+ * A process per task, waiting for a CPU in order of arrival, then saving
+ * once done, is the policy of src.hpp: it serves each preset the same as
+ * schedule_work with src.hpp. A process waiting for a CPU gets it as soon
+ * as a Cancel frees it, and a process is destroyed once the deadline of
+ * its task passes.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "coroutine.h"
+#include "src.hpp"
+#include "check.h"
+
+using namespace oj::detail::runtime;
+using oj::detail::test::check;
+
+static auto control(Process::Context &context, oj::task_id_t task_id, oj::Task task) -> Process {
+    co_await context.cpu_available(1);
+    context.submit(oj::Launch { .cpu_cnt = 1, .task_id = task_id });
+    co_await context.sleep_until(context.get_time() + oj::PublicInformation::kStartUp + task.execution_time);
+    context.submit(oj::Saving { .task_id = task_id });
+}
+
+/* Counts the processes alive which hold one. */
+struct Alive {
+    explicit Alive(int &count) : count(count) { count += 1; }
+    ~Alive() { count -= 1; }
+    int &count;
+};
+
+/**
+ * On a single CPU, the first task runs until `hold` then is cancelled,
+ * and the second one waits for the CPU, with `alive` counted at `hold`.
+ */
+static auto cancelled(Process::Context &context, oj::task_id_t task_id, oj::time_t hold,
+    int *alive, oj::time_t *resumed, int *alive_then) -> Process {
+    const Alive guard { *alive };
+    co_await context.cpu_available(1);
+    if (task_id == 0) {
+        context.submit(oj::Launch { .cpu_cnt = 1, .task_id = task_id });
+        co_await context.sleep_until(hold);
+        *alive_then = *alive;
+        context.submit(oj::Cancel { .task_id = task_id });
+    } else {
+        *resumed = context.get_time();
+    }
+}
+
+/**
+ * @return When the second task gets the CPU, and the processes alive
+ * once the first is cancelled, with the deadline of the second task.
+ */
+static auto cancel_at(oj::time_t hold, oj::time_t deadline) -> std::pair <oj::time_t, int> {
+    oj::Description desc = oj::small;
+    desc.cpu_count = 1;
+    desc.deadline_time.max = 100;
+    const std::vector <oj::Task> tasks = {
+        { .launch_time = 0, .deadline = 100, .execution_time = 50, .priority = 1 },
+        { .launch_time = 0, .deadline = deadline, .execution_time = 5, .priority = 1 },
+    };
+    int alive = 0, alive_then = 0;
+    oj::time_t resumed = 0;
+    schedule_processes(desc, tasks, [&](auto &context, oj::task_id_t task_id, const oj::Task &) {
+        return cancelled(context, task_id, hold, &alive, &resumed, &alive_then);
+    });
+    return { resumed, alive_then };
+}
+
+signed main() {
+    const auto [resumed, alive] = cancel_at(5, 100);
+    check(resumed == 5, "a waiting process gets the CPU freed by a Cancel at once");
+    check(alive == 2, "processes are alive before their deadlines");
+
+    const auto [never, destroyed] = cancel_at(20, 10);
+    check(never == 0, "a process is not resumed past its deadline");
+    check(destroyed == 1, "a process is destroyed once its deadline passes");
+
+    for (std::size_t i = 0; i < std::size(oj::testcase_array); ++i) {
+        const auto dataset = std::to_string(i);
+        // Each in a child, as the scheduler keeps its state in globals.
+        const auto expected = run_isolated([&]() -> ServiceInfo {
+            auto [desc, tasks] = load_dataset(dataset);
+            return schedule_work(desc, std::move(tasks));
+        });
+        const auto actual = run_isolated([&]() -> ServiceInfo {
+            auto [desc, tasks] = load_dataset(dataset);
+            return schedule_processes(desc, std::move(tasks), control);
+        });
+        check(actual.complete == expected.complete && actual.total == expected.total,
+            "same service as schedule_work on preset " + dataset);
+    }
+    std::cout << "coroutine_test passed" << std::endl;
+    return 0;
+}
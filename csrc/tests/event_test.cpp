@@ -0,0 +1,93 @@
+/**
+ * The event-driven runtime, driving schedule_tasks at every tick through
+ * a TickAdapter, serves each preset the same as schedule_work. A task
+ * whose saving completes is free only from the next tick.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "event.h"
+#include "src.hpp"
+#include "check.h"
+
+using namespace oj::detail::runtime;
+using oj::detail::test::check;
+
+/**
+ * Launch the only task at 0, save it at 5, and launch it again once the
+ * saving completes, either at once or at the next tick, then save it
+ * once done.
+ */
+struct Relaunch : public oj::EventScheduler {
+    static constexpr oj::time_t kExecution = 10;
+
+    explicit Relaunch(bool at_once) : at_once(at_once) {}
+
+    void on_save_complete(oj::EventContext &context, oj::task_id_t, double progress) override {
+        this->progress = progress;
+        if (at_once) this->launch(context);
+        else context.set_timer(context.get_time() + 1);
+    }
+
+    void on_timer(oj::EventContext &context, oj::time_t time) override {
+        if (time == 0) {
+            context.submit(oj::Launch { .cpu_cnt = 1, .task_id = 0 });
+            context.set_timer(5);
+        } else if (time == 5 || time == done) {
+            context.submit(oj::Saving { .task_id = 0 });
+        } else {
+            this->launch(context);
+        }
+    }
+
+private:
+    void launch(oj::EventContext &context) {
+        context.submit(oj::Launch { .cpu_cnt = 1, .task_id = 0 });
+        const auto remain = oj::time_t(std::ceil(kExecution - progress));
+        done = context.get_time() + oj::PublicInformation::kStartUp + remain;
+        context.set_timer(done);
+    }
+
+    bool        at_once;
+    double      progress = 0;
+    oj::time_t  done = 0;
+};
+
+static auto relaunch(bool at_once) -> ServiceInfo {
+    oj::Description desc = oj::small;
+    desc.cpu_count = 1;
+    desc.deadline_time.max = 100;
+    const std::vector <oj::Task> tasks = {
+        { .launch_time = 0, .deadline = 100, .execution_time = Relaunch::kExecution, .priority = 1 },
+    };
+    Relaunch scheduler { at_once };
+    return schedule_events(desc, tasks, scheduler);
+}
+
+signed main() {
+    bool rejected = false;
+    try {
+        relaunch(true);
+    } catch (const OJException &) {
+        rejected = true;
+    }
+    check(rejected, "a task is not free in its on_save_complete");
+    check(relaunch(false).complete == 1, "a task is free from the tick after");
+
+    for (std::size_t i = 0; i < std::size(oj::testcase_array); ++i) {
+        const auto dataset = std::to_string(i);
+        // Each in a child, as the scheduler keeps its state in globals.
+        const auto expected = run_isolated([&]() -> ServiceInfo {
+            auto [desc, tasks] = load_dataset(dataset);
+            return schedule_work(desc, std::move(tasks));
+        });
+        const auto actual = run_isolated([&]() -> ServiceInfo {
+            auto [desc, tasks] = load_dataset(dataset);
+            TickAdapter adapter { desc };
+            return schedule_events(desc, std::move(tasks), adapter);
+        });
+        check(actual.complete == expected.complete && actual.total == expected.total,
+            "same service as schedule_work on preset " + dataset);
+    }
+    std::cout << "event_test passed" << std::endl;
+    return 0;
+}
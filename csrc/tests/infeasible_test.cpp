@@ -0,0 +1,83 @@
+/**
+ * A running container counts towards feasibility with the progress it has
+ * not saved yet: a task is not flagged, nor cancelled, while saving it and
+ * launching it again on all the CPUs would still complete it.
+ */
+#include "runtime.h"
+#include "check.h"
+#include <limits>
+
+using namespace oj::detail::runtime;
+using oj::detail::test::check;
+
+/**
+ * One task, launched on a single CPU at tick 0, saved at `save`, then
+ * launched on all the CPUs once free, and saved at the latest.
+ * @return The first tick the task is flagged, if any, and the service.
+ */
+/* A tick to save at, which never comes. */
+constexpr auto kNever = std::numeric_limits <oj::time_t>::max();
+
+static auto run_one(oj::time_t execution_time, oj::time_t save, bool auto_cancel)
+-> std::pair <std::optional <oj::time_t>, ServiceInfo> {
+    constexpr oj::cpu_id_t kCpuCount = 16;
+
+    RuntimeManager manager {
+        { { .launch_time = 0, .deadline = 1000, .execution_time = execution_time, .priority = 1 } },
+        { .cpu_count = kCpuCount },
+    };
+    manager.set_auto_cancel(auto_cancel);
+
+    std::optional <oj::time_t> flagged;
+    for (oj::time_t time = 0; time <= 1001; ++time) {
+        manager.skip_to(time);
+        if (!flagged.has_value() && !manager.get_infeasible().empty()) flagged = time;
+
+        const auto task = manager.get_task(0);
+        std::vector <oj::Policy> policies;
+        if (time == 0) {
+            policies.push_back(oj::Launch { .cpu_cnt = 1, .task_id = 0 });
+        } else if (task.state == oj::WorkState::Launch && task.cpu_cnt == 1) {
+            if (time == save) policies.push_back(oj::Saving { .task_id = 0 });
+        } else if (task.state == oj::WorkState::Free && task.progress < execution_time) {
+            policies.push_back(oj::Launch { .cpu_cnt = kCpuCount, .task_id = 0 });
+        } else if (task.state == oj::WorkState::Launch) {
+            if (time == 1000 - oj::PublicInformation::kSaving)
+                policies.push_back(oj::Saving { .task_id = 0 });
+        }
+        manager.work(std::move(policies));
+    }
+    return { flagged, manager.get_service_info() };
+}
+
+signed main() {
+    // The last tick the container on 1 CPU may be saved, to complete on all.
+    oj::time_t last_save = 0;
+    for (oj::time_t save = 1; save < 1000; ++save)
+        if (run_one(1200, save, false).second.complete == 1) last_save = save;
+    check(last_save > 0, "the task may complete when saved early enough");
+
+    for (const bool auto_cancel : { false, true }) {
+        // The container completes it by itself, when saved in time.
+        const auto [flagged, info] = run_one(300, 302, auto_cancel);
+        check(!flagged.has_value(), "a container able to complete is not flagged");
+        check(info.complete == 1, "a container able to complete is not cancelled");
+
+        // The container alone is too slow, but gets far enough to switch.
+        const auto [late, switched] = run_one(1200, last_save, auto_cancel);
+        check(!late.has_value(), "unsaved progress counts while running");
+        check(switched.complete == 1, "the task saved late completes on all the CPUs");
+    }
+
+    // Never saved, it is flagged once switching could no longer make it.
+    const auto [flagged, info] = run_one(1200, kNever, true);
+    check(flagged == last_save + 1, "flagged right after the last save to switch");
+    check(info.complete == 0, "a task too late to switch is cancelled");
+
+    // Never saved, the container able to complete is flagged once too late.
+    const auto [alone, cancelled] = run_one(300, kNever, true);
+    check(alone == 1000 - oj::PublicInformation::kSaving + 1, "flagged right after the last save");
+    check(cancelled.complete == 0, "a container never saved is cancelled");
+    std::cout << "infeasible_test passed" << std::endl;
+    return 0;
+}
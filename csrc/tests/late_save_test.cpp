@@ -0,0 +1,47 @@
+/**
+ * As in the judge, a task whose saving completes after its deadline is
+ * never free again: it may not be launched, until cancelled. Its CPUs
+ * are released all the same.
+ */
+#include "runtime.h"
+#include "check.h"
+
+using namespace oj::detail::runtime;
+using oj::detail::test::check;
+
+static auto launch_fails(RuntimeManager &manager) -> bool {
+    try {
+        manager.work(std::vector <oj::Policy> { oj::Launch { .cpu_cnt = 1, .task_id = 0 } });
+    } catch (const OJException &) {
+        return true;
+    }
+    return false;
+}
+
+signed main() {
+    RuntimeManager manager {
+        { { .launch_time = 0, .deadline = 10, .execution_time = 5, .priority = 1 } },
+        { .cpu_count = 1 },
+    };
+
+    manager.skip_to(0);
+    manager.work(std::vector <oj::Policy> { oj::Launch { .cpu_cnt = 1, .task_id = 0 } });
+    manager.skip_to(9);
+    manager.work(std::vector <oj::Policy> { oj::Saving { .task_id = 0 } });
+
+    // The saving completes at 11, past the deadline.
+    manager.skip_to(12);
+    check(manager.get_cpu_usage() == 0, "the CPUs are released");
+    check(manager.get_task(0).state == oj::WorkState::Saving, "the task stays saving");
+    check(launch_fails(manager), "a task saved too late is not launched again");
+    check(manager.get_service_info().complete == 0, "progress saved too late is discarded");
+
+    manager.skip_to(13);
+    manager.work(std::vector <oj::Policy> { oj::Cancel { .task_id = 0 } });
+    check(manager.get_task(0).state == oj::WorkState::Free, "a cancelled task is free");
+    check(!launch_fails(manager), "a cancelled task may be launched again");
+    check(manager.get_cpu_usage() == 1, "the task launched again holds its CPU");
+
+    std::cout << "late_save_test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,31 @@
+/**
+ * The pipelined runtime makes the same calls to schedule_tasks as
+ * schedule_work, so it serves each preset the same.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "pipeline.h"
+#include "src.hpp"
+#include "check.h"
+
+using namespace oj::detail::runtime;
+using oj::detail::test::check;
+
+signed main() {
+    for (std::size_t i = 0; i < std::size(oj::testcase_array); ++i) {
+        const auto dataset = std::to_string(i);
+        // Each in a child, as the scheduler keeps its state in globals.
+        const auto expected = run_isolated([&]() -> ServiceInfo {
+            auto [desc, tasks] = load_dataset(dataset);
+            return schedule_work(desc, std::move(tasks));
+        });
+        const auto actual = run_isolated([&]() -> ServiceInfo {
+            auto [desc, tasks] = load_dataset(dataset);
+            return schedule_pipelined(desc, std::move(tasks));
+        });
+        check(actual.complete == expected.complete && actual.total == expected.total,
+            "same service as schedule_work on preset " + dataset);
+    }
+    std::cout << "pipeline_test passed" << std::endl;
+    return 0;
+}
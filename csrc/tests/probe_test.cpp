@@ -0,0 +1,44 @@
+/**
+ * Probes nest around each step of schedule_loop: the first probe given
+ * is the innermost, so that its before_ hook is called last, and its
+ * after_ hook first.
+ */
+#include "runtime.h"
+#include "src.hpp"
+#include "check.h"
+
+using namespace oj::detail::runtime;
+using oj::detail::test::check;
+
+/* Logs its hooks of the first tick. */
+struct OrderProbe : public Probe {
+    OrderProbe(char name, std::string &log) : name(name), log(log) {}
+
+    void before_synchronize(oj::time_t time) { this->put(time, "bs"); }
+    void after_synchronize(oj::time_t time, const std::vector <oj::Task> &) { this->put(time, "as"); }
+    void before_schedule(oj::time_t time) { this->put(time, "bc"); }
+    void after_schedule(oj::time_t time, const std::vector <oj::Policy> &) { this->put(time, "ac"); }
+    void before_work(oj::time_t time) { this->put(time, "bw"); }
+    void after_work(oj::time_t time) { this->put(time, "aw"); }
+
+private:
+    void put(oj::time_t time, std::string_view hook) {
+        if (time != 0) return;
+        log += hook;
+        log += name;
+        log += ' ';
+    }
+
+    char         name;
+    std::string &log;
+};
+
+signed main() {
+    std::string log;
+    OrderProbe inner { 'A', log }, outer { 'B', log };
+    schedule_work(oj::small, generate_work(oj::small), inner, outer);
+    check(log == "bsB bsA asA asB bcB bcA acA acB bwB bwA awA awB ",
+        "the first probe is the innermost, got: " + log);
+    std::cout << "probe_test passed" << std::endl;
+    return 0;
+}
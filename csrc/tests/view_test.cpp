@@ -0,0 +1,40 @@
+/**
+ * The runtime view is only given within schedule_tasks, and a scheduler
+ * reading its free CPUs from it, as view_example.hpp does, serves the
+ * presets the same as src.hpp counting them by itself.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "view_example.hpp"
+#include "check.h"
+
+using namespace oj::detail::runtime;
+using oj::detail::test::check;
+
+signed main() {
+    bool outside = false;
+    try {
+        oj::runtime_view();
+    } catch (const OJException &) {
+        outside = true;
+    }
+    check(outside, "no view outside schedule_tasks");
+
+    // As served by src.hpp.
+    constexpr ServiceInfo kReference[] = {
+        { .complete = 67716,  .total = 100000 },
+        { .complete = 114514, .total = 114514 },
+        { .complete = 100000, .total = 100000 },
+    };
+    for (std::size_t i = 0; i < std::size(kReference); ++i) {
+        // Each in a child, as the scheduler keeps its state in globals.
+        const auto info = run_isolated([&]() -> ServiceInfo {
+            auto [desc, tasks] = load_dataset(std::to_string(i + 1));
+            return schedule_work(desc, std::move(tasks));
+        });
+        check(info.complete == kReference[i].complete && info.total == kReference[i].total,
+            "same service as src.hpp on preset " + std::to_string(i + 1));
+    }
+    std::cout << "view_test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,30 @@
+/**
+ * Export the timeline of a simulation as Chrome trace-event JSON.
+ *
+ * Usage: trace <dataset> <output.json>
+ * A dataset is either a file serialized by client.cpp,
+ * or the index (0 ~ 3) of a preset in testcase_array.
+ */
+#include "runtime.h"
+#include "harness.h"
+#include "trace.h"
+#include "src.hpp"
+
+signed main(int argc, char *argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <dataset> <output.json>\n";
+        return 1;
+    }
+    try {
+        using namespace oj::detail::runtime;
+        auto [desc, tasks] = load_dataset(argv[1]);
+        TraceExporter exporter { argv[2] };
+        const auto info = schedule_work(desc, std::move(tasks), exporter);
+        std::cout << "complete " << info.complete
+                  << " total " << info.total << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
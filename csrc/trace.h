@@ -0,0 +1,328 @@
+#pragma once
+#include "runtime.h"
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Timelines of a simulation, as Chrome trace-event JSON, which opens in
+ * chrome://tracing or ui.perfetto.dev. One tick is shown as 1 us.
+ *
+ * Each container gets a track, reused once it is released, with its
+ * start-up, execution and saving phases, and marks where it is cancelled.
+ * A counter track follows the CPU usage after each tick.
+ */
+namespace oj::detail::runtime {
+
+/* An event of the trace, formatted later on the writer thread. */
+struct TraceRecord {
+    enum class Kind : std::uint8_t {
+        StartUp, Execute, Saving, Cancel, Usage, Track,
+    };
+
+    Kind            kind;
+    cpu_id_t        cpu_cnt;    // CPUs of the container, or in use
+    std::uint32_t   track;
+    task_id_t       task_id;
+    time_t          from;
+    time_t          to;
+};
+
+/**
+ * @brief Formats and writes the records on a thread of its own, so that
+ * the simulation only pays for copying them into a buffer.
+ */
+struct TraceWriter {
+    static constexpr std::size_t kChunk = 1 << 14;
+
+    explicit TraceWriter(const std::filesystem::path &path)
+        : os(path, std::ios::binary) {
+        if (!os)
+            panic <SystemException> ("Trace: Cannot open the output.");
+        buffer.reserve(kChunk);
+        thread = std::thread([this] { this->loop(); });
+    }
+
+    ~TraceWriter() { this->close(); }
+
+    TraceWriter(const TraceWriter &) = delete;
+    auto operator = (const TraceWriter &) -> TraceWriter & = delete;
+
+    void push(const TraceRecord &record) {
+        buffer.push_back(record);
+        if (buffer.size() == kChunk) this->flush();
+    }
+
+    /* Hand the buffer over to the thread. */
+    void flush() {
+        if (buffer.empty()) return;
+        std::vector <TraceRecord> next;
+        {
+            const std::lock_guard lock { mutex };
+            if (!spare.empty()) {
+                next = std::move(spare.back());
+                spare.pop_back();
+            }
+            chunks.push_back(std::exchange(buffer, std::move(next)));
+        }
+        buffer.reserve(kChunk);
+        ready.notify_one();
+    }
+
+    /* Flush and wait for everything to be written. */
+    void close() {
+        if (!thread.joinable()) return;
+        this->flush();
+        {
+            const std::lock_guard lock { mutex };
+            closed = true;
+        }
+        ready.notify_one();
+        thread.join();
+    }
+
+private:
+    /* Appends to a line of a record, which is far longer than needed. */
+    struct Line {
+        void put(std::string_view text) {
+            std::memcpy(end, text.data(), text.size());
+            end += text.size();
+        }
+
+        void put(std::uint64_t value) {
+            end = std::to_chars(end, std::end(data), value).ptr;
+        }
+
+        char    data[256];
+        char   *end = data;
+    };
+
+    void format(const TraceRecord &record) {
+        using enum TraceRecord::Kind;
+        constexpr std::string_view kName[] = { "start_up", "execute", "saving", "cancel" };
+
+        Line line;
+        line.put(",\n");
+
+        switch (record.kind) {
+            case StartUp: case Execute: case Saving:
+                line.put(R"({"ph":"X","pid":0,"name":")");
+                line.put(kName[std::size_t(record.kind)]);
+                line.put(R"(","tid":)");
+                line.put(record.track);
+                line.put(R"(,"ts":)");
+                line.put(record.from);
+                line.put(R"(,"dur":)");
+                line.put(record.to - record.from);
+                line.put(R"(,"args":{"task":)");
+                line.put(record.task_id);
+                line.put(R"(,"cpu":)");
+                line.put(record.cpu_cnt);
+                line.put("}}");
+                break;
+            case Cancel:
+                line.put(R"({"ph":"i","s":"t","pid":0,"name":"cancel","tid":)");
+                line.put(record.track);
+                line.put(R"(,"ts":)");
+                line.put(record.from);
+                line.put(R"(,"args":{"task":)");
+                line.put(record.task_id);
+                line.put("}}");
+                break;
+            case Usage:
+                line.put(R"({"ph":"C","pid":0,"name":"cpu_usage","ts":)");
+                line.put(record.from);
+                line.put(R"(,"args":{"used":)");
+                line.put(record.cpu_cnt);
+                line.put("}}");
+                break;
+            case Track:
+                line.put(R"({"ph":"M","pid":0,"name":"thread_name","tid":)");
+                line.put(record.track);
+                line.put(R"(,"args":{"name":"container )");
+                line.put(record.track);
+                line.put(R"("}})");
+                break;
+        }
+        text_buffer.append(line.data, line.end);
+    }
+
+    void loop() {
+        text_buffer += R"({"displayTimeUnit":"ms","traceEvents":[)" "\n";
+        text_buffer += R"({"ph":"M","pid":0,"name":"process_name","args":{"name":"cluster"}})";
+
+        std::unique_lock lock { mutex };
+        while (true) {
+            ready.wait(lock, [this] { return closed || !chunks.empty(); });
+            if (chunks.empty()) break;
+            auto chunk = std::move(chunks.front());
+            chunks.pop_front();
+
+            lock.unlock();
+            for (const auto &record : chunk) this->format(record);
+            os.write(text_buffer.data(), text_buffer.size());
+            text_buffer.clear();
+            chunk.clear();
+            lock.lock();
+
+            spare.push_back(std::move(chunk));
+        }
+
+        os << "\n]}\n";
+        os.flush();
+    }
+
+    std::ofstream                           os;
+    std::vector <TraceRecord>               buffer;     // Filled by the simulation
+    std::mutex                              mutex;
+    std::condition_variable                 ready;
+    std::deque <std::vector <TraceRecord>>  chunks;     // Waiting to be written
+    std::vector <std::vector <TraceRecord>> spare;      // Written, for reuse
+    bool                                    closed = false;
+    std::string                             text_buffer;
+    std::thread                             thread;
+};
+
+/**
+ * @brief Records the containers of a run, as a probe of schedule_work
+ * which also listens to the runtime.
+ */
+struct TraceExporter : public Probe, public RuntimeListener {
+private:
+    using Kind = TraceRecord::Kind;
+
+    struct Container {
+        std::uint32_t   track;
+        cpu_id_t        cpu_cnt;
+        time_t          launch;
+        time_t          saving;     // When saving starts, if it does
+        bool            is_saving;
+    };
+
+    /* A phase [from, to) on the track of a container. */
+    void phase(Kind kind, task_id_t task_id, const Container &container, time_t from, time_t to) {
+        if (from >= to) return;
+        writer.push({
+            .kind       = kind,
+            .cpu_cnt    = container.cpu_cnt,
+            .track      = container.track,
+            .task_id    = task_id,
+            .from       = from,
+            .to         = to,
+        });
+    }
+
+    /* The phases of a container which ends at the time. */
+    auto finish(task_id_t task_id, time_t time) -> Container {
+        const auto iter = containers.find(task_id);
+        const auto container = iter->second;
+        containers.erase(iter);
+        const auto ready = container.launch + start_up;
+        const auto until = container.is_saving ? container.saving : time;
+        this->phase(Kind::StartUp, task_id, container, container.launch, std::min(ready, until));
+        this->phase(Kind::Execute, task_id, container, ready, until);
+        if (container.is_saving)
+            this->phase(Kind::Saving, task_id, container, until, time);
+        free_tracks.push(container.track);
+        return container;
+    }
+
+public:
+    explicit TraceExporter(const std::filesystem::path &path) : writer(path) {}
+
+    void on_start(RuntimeManager &manager) {
+        start_up = manager.get_cluster().start_up;
+        manager.add_listener(*this);
+    }
+
+    void on_launch(task_id_t task_id, cpu_id_t cpu_cnt, time_t time) override {
+        auto track = track_count;
+        if (free_tracks.empty()) {
+            track_count += 1;
+        } else {
+            track = free_tracks.top();
+            free_tracks.pop();
+        }
+        containers.emplace(task_id, Container {
+            .track      = track,
+            .cpu_cnt    = cpu_cnt,
+            .launch     = time,
+            .saving     = 0,
+            .is_saving  = false,
+        });
+    }
+
+    void on_saving(task_id_t task_id, time_t time) override {
+        auto &container = containers.at(task_id);
+        container.saving = time;
+        container.is_saving = true;
+    }
+
+    void on_saved(task_id_t task_id, time_t time) override {
+        this->finish(task_id, time);
+    }
+
+    void on_cancel(task_id_t task_id, time_t time) override {
+        const auto container = this->finish(task_id, time);
+        writer.push({
+            .kind       = Kind::Cancel,
+            .cpu_cnt    = container.cpu_cnt,
+            .track      = container.track,
+            .task_id    = task_id,
+            .from       = time,
+            .to         = time,
+        });
+    }
+
+    void after_work(time_t time) {
+        const auto usage = runtime_view().get_cpu_usage();
+        if (usage == cpu_usage) return;
+        cpu_usage = usage;
+        writer.push({
+            .kind       = Kind::Usage,
+            .cpu_cnt    = usage,
+            .track      = 0,
+            .task_id    = 0,
+            .from       = time,
+            .to         = time,
+        });
+    }
+
+    /* Close the containers still running, name the tracks and wait. */
+    void on_finish(const RuntimeManager &manager) {
+        const auto time = manager.get_time();
+        std::vector <task_id_t> running;
+        for (const auto &[task_id, container] : containers) running.push_back(task_id);
+        std::ranges::sort(running);
+        for (const auto task_id : running) this->finish(task_id, time);
+
+        for (std::uint32_t track = 0; track < track_count; ++track) {
+            writer.push({
+                .kind       = Kind::Track,
+                .cpu_cnt    = 0,
+                .track      = track,
+                .task_id    = 0,
+                .from       = 0,
+                .to         = 0,
+            });
+        }
+        writer.close();
+    }
+
+private:
+    TraceWriter     writer;
+    time_t          start_up = 0;
+    cpu_id_t        cpu_usage = 0;
+    std::uint32_t   track_count = 0;
+    std::priority_queue <std::uint32_t, std::vector <std::uint32_t>, std::greater <>> free_tracks;
+    // Only those running or saving, so memory is bounded by the live tasks.
+    std::unordered_map <task_id_t, Container> containers;
+};
+
+} // namespace oj::detail::runtime
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "definition.h"
+#include "interface.h"
+
+#include <queue>
+#include <map>
+
+/**
+ * The reference policy of src.hpp, rewritten on top of runtime_view():
+ * free CPUs are read from the runtime instead of being counted, and tasks
+ * already known to be infeasible are skipped instead of launched.
+ * The view is not part of the OJ interface, so this is only for the local
+ * tools, e.g. built with -DOJ_SCHEDULER='"view_example.hpp"'. The view is
+ * not given on the scheduler thread of pipeline.h, so neither is it for
+ * the pipelined mode.
+ */
+namespace oj {
+
+  auto generate_tasks(const Description &desc) -> std::vector<Task> {
+    std::vector<Task> ret;
+    size_t average_time = std::max(desc.execution_time_single.min, desc.execution_time_sum.min / desc.task_count + 1);
+    size_t average_priority = desc.priority_single.min;
+    for (size_t i = 0; i < desc.task_count; i++) {
+      ret.push_back(
+        {0, desc.deadline_time.max, average_time, average_priority});
+    }
+    return ret;
+  }
+
+} // namespace oj
+
+namespace oj {
+  std::queue<std::pair<size_t, Task>> q;
+  task_id_t task_id = 0;
+  std::map<size_t, std::vector<size_t>> savings;
+
+  auto schedule_tasks(time_t time, std::vector<Task> list, const Description &desc) -> std::vector<Policy> {
+    std::vector<Policy> ret;
+    const auto &view = runtime_view();
+    size_t free_cpu = desc.cpu_count - view.get_cpu_usage();
+    for (const auto &release : view.get_releases()) {
+      if (release.time > time) break;
+      free_cpu += release.cpu_cnt;
+    }
+    for (size_t i = 0; i < list.size(); i++) {
+      q.emplace(task_id + i, list[i]);
+    }
+    if (auto it = savings.find(time); it != savings.end()) {
+      for (size_t id: it->second) {
+        ret.emplace_back(Saving{id});
+      }
+      savings.erase(it);
+    }
+    while (!q.empty() && free_cpu > 0) {
+      auto t = q.front();
+      q.pop();
+      if (view.get_task(t.first).infeasible) continue;
+      ret.emplace_back(Launch{1, t.first});
+      savings[time + PublicInformation::kStartUp + t.second.execution_time].push_back(t.first);
+      free_cpu--;
+    }
+    task_id += list.size();
+    return ret;
+  }
+
+} // namespace oj
@@ -0,0 +1,189 @@
+#pragma once
+#include "runtime.h"
+#include <array>
+#include <utility>
+
+/**
+ * Where the capacity of the cluster goes, in CPU-ticks. A container of
+ * c CPUs holds c CPU-ticks per tick, from its launch until it is either
+ * cancelled or done saving. These are split into start-up, execution
+ * and saving, and the execution is useful only if its saving counts.
+ */
+namespace oj::detail::runtime {
+
+enum class Waste : std::size_t {
+    StartUp,    // Starting up, before any progress
+    Saving,     // Saving progress
+    Cancelled,  // Progress of containers cancelled before saving it
+    Discarded,  // Progress saved too late, e.g. after the deadline
+    Useful,     // Progress saved in time
+    Count
+};
+
+inline constexpr std::array <std::string_view, std::size_t(Waste::Count)> kWasteName = {
+    "start_up", "saving", "cancelled", "discarded", "useful",
+};
+
+using WasteValues = std::array <std::uint64_t, std::size_t(Waste::Count)>;
+
+/**
+ * @brief Accounts the CPU-ticks of every container by category and by the
+ * priority of the task. Priorities are bucketed by powers of two, that is,
+ * bucket k holds priorities in [2^(k-1), 2^k).
+ */
+struct WasteAccountant : public Probe, public RuntimeListener {
+private:
+    struct Container {
+        cpu_id_t    cpu_cnt;
+        time_t      launch;
+        time_t      saving;     // When saving starts, if it does
+        bool        is_saving;
+    };
+
+    struct Info {
+        priority_t  priority;
+        time_t      deadline;
+        bool        retired;
+    };
+
+    void add(task_id_t task_id, Waste waste, cpu_id_t cpu_cnt, time_t from, time_t to) {
+        if (from >= to) return;
+        const auto priority = tasks[task_id].priority;
+        const auto bucket = std::size_t(std::bit_width(priority));
+        if (bucket >= buckets.size()) buckets.resize(bucket + 1);
+        const auto ticks = std::uint64_t(cpu_cnt) * (to - from);
+        buckets[bucket][std::size_t(waste)] += ticks;
+        occupied += ticks;
+    }
+
+    /* Account a container which ends at the time, with its progress as given. */
+    void finish(task_id_t task_id, time_t time, Waste progress) {
+        const auto container = *std::exchange(containers[task_id], std::nullopt);
+        live_count -= 1;
+
+        const auto [cpu_cnt, launch, saving, is_saving] = container;
+        const auto ready = launch + start_up;
+        const auto until = is_saving ? saving : time;
+        this->add(task_id, Waste::StartUp, cpu_cnt, launch, std::min(ready, until));
+        this->add(task_id, progress, cpu_cnt, ready, until);
+        if (is_saving)
+            this->add(task_id, Waste::Saving, cpu_cnt, saving, time);
+    }
+
+public:
+    void on_start(RuntimeManager &manager) {
+        start_up = manager.get_cluster().start_up;
+        cpu_count = manager.get_cluster().cpu_count;
+        manager.add_listener(*this);
+    }
+
+    void on_arrive(task_id_t task_id, const Task &task) override {
+        if (task_id >= tasks.size())
+            tasks.resize(std::max <std::size_t> (task_id + 1, tasks.size() * 2));
+        tasks[task_id] = { task.priority, task.deadline, false };
+    }
+
+    void on_launch(task_id_t task_id, cpu_id_t cpu_cnt, time_t time) override {
+        if (task_id >= containers.size())
+            containers.resize(std::max <std::size_t> (task_id + 1, containers.size() * 2));
+        containers[task_id] = Container {
+            .cpu_cnt    = cpu_cnt,
+            .launch     = time,
+            .saving     = 0,
+            .is_saving  = false,
+        };
+        live_count += 1;
+    }
+
+    void on_saving(task_id_t task_id, time_t time) override {
+        auto &container = *containers[task_id];
+        container.saving = time;
+        container.is_saving = true;
+    }
+
+    void on_saved(task_id_t task_id, time_t time) override {
+        // Same rule as RuntimeManager::complete_saving.
+        const auto &task = tasks[task_id];
+        const bool in_time = !task.retired && time <= task.deadline;
+        this->finish(task_id, time, in_time ? Waste::Useful : Waste::Discarded);
+    }
+
+    void on_cancel(task_id_t task_id, time_t time) override {
+        this->finish(task_id, time, Waste::Cancelled);
+    }
+
+    void on_retire(task_id_t task_id) override {
+        // Any later container of the task is wasted.
+        tasks[task_id].retired = true;
+    }
+
+    /* Containers still running at the end never save in time. */
+    void on_finish(const RuntimeManager &manager) {
+        total_ticks = manager.get_time();
+        for (task_id_t task_id = 0; live_count != 0; ++task_id)
+            if (containers[task_id].has_value())
+                this->finish(task_id, total_ticks, Waste::Discarded);
+    }
+
+    /* CPU-ticks of the cluster over the run. */
+    auto get_capacity() const -> std::uint64_t {
+        return std::uint64_t(cpu_count) * total_ticks;
+    }
+
+    auto get_idle() const -> std::uint64_t {
+        return this->get_capacity() - occupied;
+    }
+
+    auto get_bucket_count() const -> std::size_t {
+        return buckets.size();
+    }
+
+    auto get_bucket(std::size_t bucket) const -> const WasteValues & {
+        return buckets[bucket];
+    }
+
+    auto get_total() const -> WasteValues {
+        WasteValues result {};
+        for (const auto &bucket : buckets)
+            for (std::size_t i = 0; i < result.size(); ++i)
+                result[i] += bucket[i];
+        return result;
+    }
+
+    void report(std::ostream &os) const {
+        const auto capacity = std::max <std::uint64_t> (this->get_capacity(), 1);
+        auto print = [&](std::string_view name, std::uint64_t ticks) {
+            os << ' ' << name << ' ' << ticks << " (" << 100.0 * ticks / capacity << "%)";
+        };
+
+        os << std::fixed << std::setprecision(2);
+        os << "capacity " << this->get_capacity();
+        print("idle", this->get_idle());
+        const auto total = this->get_total();
+        for (std::size_t i = 0; i < total.size(); ++i)
+            print(kWasteName[i], total[i]);
+        os << '\n';
+
+        for (std::size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+            const auto &values = buckets[bucket];
+            if (std::ranges::all_of(values, [](auto x) { return x == 0; })) continue;
+            os << "priority [" << (std::uint64_t(1) << bucket >> 1)
+               << ", " << (std::uint64_t(1) << bucket) << ')';
+            for (std::size_t i = 0; i < values.size(); ++i)
+                print(kWasteName[i], values[i]);
+            os << '\n';
+        }
+    }
+
+private:
+    time_t          start_up = 0;
+    cpu_id_t        cpu_count = 0;
+    time_t          total_ticks = 0;
+    std::uint64_t   occupied = 0;       // CPU-ticks held by containers
+    std::vector <Info> tasks;           // By task ID
+    std::vector <std::optional <Container>> containers;  // By task ID
+    std::size_t     live_count = 0;
+    std::vector <WasteValues> buckets;  // By priority bucket
+};
+
+} // namespace oj::detail::runtime